@@ -0,0 +1,148 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "api/api_search_cache.h"
+
+#include "apiwrap.h"
+#include "data/data_changes.h"
+#include "data/data_peer.h"
+#include "data/data_peer_id.h"
+#include "data/data_session.h"
+#include "history/history.h"
+#include "history/history_item.h"
+#include "main/main_session.h"
+
+namespace Api {
+namespace {
+
+// Upper bound for message ids kept in all the cached pages together.
+constexpr auto kMaxStoredIds = 10000;
+
+} // namespace
+
+SearchResultsCache::SearchResultsCache(not_null<ApiWrap*> api)
+: _session(&api->session()) {
+	crl::on_main(_session, [=] {
+		// Data::Session is not constructed yet, subscribe queued.
+		setupInvalidation();
+	});
+}
+
+void SearchResultsCache::setupInvalidation() {
+	_session->data().newItemAdded(
+	) | rpl::start_with_next([=](not_null<HistoryItem*> item) {
+		removeAfter(item->history()->peer->id, item->id);
+	}, _lifetime);
+
+	_session->data().itemRemoved(
+	) | rpl::start_with_next([=](not_null<const HistoryItem*> item) {
+		removeMessage(item->history()->peer->id, item->id);
+	}, _lifetime);
+
+	_session->changes().messageUpdates(
+		Data::MessageUpdate::Flag::Edited
+	) | rpl::start_with_next([=](const Data::MessageUpdate &update) {
+		removeEdited(update.item->history()->peer->id, update.item->id);
+	}, _lifetime);
+
+	_session->data().historyCleared(
+	) | rpl::start_with_next([=](not_null<const History*> history) {
+		removePeer(history->peer->id);
+	}, _lifetime);
+}
+
+std::optional<SearchResult> SearchResultsCache::lookup(const Key &key) {
+	const auto i = _entries.find(key);
+	if (i == end(_entries)) {
+		return std::nullopt;
+	} else if (!allExist(key.peerId, i->second.result.messageIds)) {
+		_storedIds -= int(i->second.result.messageIds.size());
+		_entries.erase(i);
+		return std::nullopt;
+	}
+	i->second.lastUsed = ++_usedCounter;
+	return i->second.result;
+}
+
+void SearchResultsCache::store(const Key &key, const SearchResult &result) {
+	const auto size = int(result.messageIds.size());
+	if (size > kMaxStoredIds) {
+		return;
+	}
+	auto &entry = _entries[key];
+	_storedIds += size - int(entry.result.messageIds.size());
+	entry.result = result;
+	entry.lastUsed = ++_usedCounter;
+	while (_storedIds > kMaxStoredIds) {
+		removeLeastRecentlyUsed();
+	}
+}
+
+bool SearchResultsCache::allExist(
+		PeerId peerId,
+		const std::vector<MsgId> &ids) const {
+	const auto channelId = peerToChannel(peerId);
+	return ranges::all_of(ids, [&](MsgId id) {
+		return _session->data().message(channelId, id) != nullptr;
+	});
+}
+
+void SearchResultsCache::removeIf(
+		Fn<bool(const Key &, const Entry &)> predicate) {
+	for (auto i = begin(_entries); i != end(_entries);) {
+		if (predicate(i->first, i->second)) {
+			_storedIds -= int(i->second.result.messageIds.size());
+			i = _entries.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void SearchResultsCache::removePeer(PeerId peerId) {
+	removeIf([&](const Key &key, const Entry &entry) {
+		return (key.peerId == peerId);
+	});
+}
+
+void SearchResultsCache::removeMessage(PeerId peerId, MsgId messageId) {
+	removeIf([&](const Key &key, const Entry &entry) {
+		return (key.peerId == peerId)
+			&& ranges::contains(entry.result.messageIds, messageId);
+	});
+}
+
+void SearchResultsCache::removeEdited(PeerId peerId, MsgId messageId) {
+	// An edited message may start or stop matching the query or the type.
+	removeIf([&](const Key &key, const Entry &entry) {
+		return (key.peerId == peerId)
+			&& ((entry.result.noSkipRange.from <= messageId
+				&& entry.result.noSkipRange.till >= messageId)
+				|| ranges::contains(entry.result.messageIds, messageId));
+	});
+}
+
+void SearchResultsCache::removeAfter(PeerId peerId, MsgId messageId) {
+	// A new message may land in any page that reaches up to its id.
+	removeIf([&](const Key &key, const Entry &entry) {
+		return (key.peerId == peerId)
+			&& (entry.result.noSkipRange.till >= messageId);
+	});
+}
+
+void SearchResultsCache::removeLeastRecentlyUsed() {
+	Expects(!_entries.empty());
+
+	const auto i = ranges::min_element(
+		_entries,
+		ranges::less(),
+		[](const auto &pair) { return pair.second.lastUsed; });
+	_storedIds -= int(i->second.result.messageIds.size());
+	_entries.erase(i);
+}
+
+} // namespace Api
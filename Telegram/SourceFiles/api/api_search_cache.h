@@ -0,0 +1,74 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "data/data_search_controller.h"
+#include "data/data_messages.h"
+
+class ApiWrap;
+
+namespace Main {
+class Session;
+} // namespace Main
+
+namespace Api {
+
+// Keeps recently received search / shared media pages, so that reopening
+// the same section or repeating the same query is answered locally.
+class SearchResultsCache final {
+public:
+	struct Key {
+		PeerId peerId = 0;
+		Storage::SharedMediaType type = Storage::SharedMediaType::kCount;
+		QString query;
+		MsgId aroundId = 0;
+		Data::LoadDirection direction = Data::LoadDirection::Around;
+
+		friend inline auto value_ordering_helper(const Key &value) {
+			return std::tie(
+				value.peerId,
+				value.type,
+				value.query,
+				value.aroundId,
+				value.direction);
+		}
+	};
+
+	explicit SearchResultsCache(not_null<ApiWrap*> api);
+
+	[[nodiscard]] std::optional<SearchResult> lookup(const Key &key);
+	void store(const Key &key, const SearchResult &result);
+
+private:
+	struct Entry {
+		SearchResult result;
+		uint64 lastUsed = 0;
+	};
+
+	void setupInvalidation();
+	void removeIf(Fn<bool(const Key &, const Entry &)> predicate);
+	void removePeer(PeerId peerId);
+	void removeMessage(PeerId peerId, MsgId messageId);
+	void removeEdited(PeerId peerId, MsgId messageId);
+	void removeAfter(PeerId peerId, MsgId messageId);
+	void removeLeastRecentlyUsed();
+	[[nodiscard]] bool allExist(
+		PeerId peerId,
+		const std::vector<MsgId> &ids) const;
+
+	const not_null<Main::Session*> _session;
+
+	std::map<Key, Entry> _entries;
+	int _storedIds = 0;
+	uint64 _usedCounter = 0;
+
+	rpl::lifetime _lifetime;
+
+};
+
+} // namespace Api
@@ -61,6 +61,11 @@ constexpr auto kNoUpdatesTimeout = 60 * 1000;
 // If nothing is received in 1 min when was a sleepmode we ping.
 constexpr auto kNoUpdatesAfterSleepTimeout = 60 * crl::time(1000);
 
+// New messages from getDifference are added in steps of that size,
+// returning to the event loop when a step took more than that time.
+constexpr auto kDifferenceMessagesStep = 50;
+constexpr auto kDifferenceMessagesStepTime = crl::time(20);
+
 enum class DataIsLoadedResult {
 	NotLoaded = 0,
 	FromNotLoaded = 1,
@@ -209,8 +214,66 @@ DataIsLoadedResult AllDataLoadedForMessage(
 	});
 }
 
+// Drops entries serialized exactly the same way as an earlier one.
+// Different entries for one peer are all kept, because a later one
+// can lack some optional fields that an earlier one has.
+template <typename Type>
+[[nodiscard]] QVector<Type> RemoveExactDuplicates(
+		const QVector<Type> &list,
+		int &removed) {
+	auto serialized = std::vector<std::pair<mtpBuffer, int>>();
+	serialized.reserve(list.size());
+	for (auto i = 0, count = int(list.size()); i != count; ++i) {
+		auto buffer = mtpBuffer();
+		list[i].write(buffer);
+		serialized.emplace_back(std::move(buffer), i);
+	}
+	ranges::sort(serialized);
+
+	auto skip = std::vector<char>(list.size(), 0);
+	auto skipped = 0;
+	for (auto i = 1, count = int(serialized.size()); i < count; ++i) {
+		if (serialized[i].first == serialized[i - 1].first) {
+			skip[serialized[i].second] = 1;
+			++skipped;
+		}
+	}
+	if (!skipped) {
+		return list;
+	}
+	removed += skipped;
+	auto result = QVector<Type>();
+	result.reserve(list.size() - skipped);
+	for (auto i = 0, count = int(list.size()); i != count; ++i) {
+		if (!skip[i]) {
+			result.push_back(list[i]);
+		}
+	}
+	return result;
+}
+
+// The same order Data::Session::processMessages() adds messages in.
+[[nodiscard]] QVector<MTPMessage> SortMessagesById(
+		QVector<MTPMessage> list) {
+	ranges::stable_sort(list, ranges::less(), [](const MTPMessage &message) {
+		return uint32(IdFromMessage(message).bare);
+	});
+	return list;
+}
+
 } // namespace
 
+struct Updates::PreparedDifference {
+	QVector<MTPUser> users;
+	QVector<MTPChat> chats;
+	QVector<MTPMessage> messages;
+	QVector<MTPUpdate> messageIds;
+	QVector<MTPUpdate> other;
+	int duplicates = 0;
+	int messagesAdded = 0;
+	crl::time messagesDuration = 0;
+};
+
 Updates::Updates(not_null<Main::Session*> session)
 : _session(session)
 , _noUpdatesTimer([=] { sendPing(); })
@@ -460,23 +523,25 @@ void Updates::differenceDone(const MTPupdates_Difference &result) {
 	} break;
 	case mtpc_updates_differenceSlice: {
 		auto &d = result.c_updates_differenceSlice();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
+		const auto state = d.vintermediate_state();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			auto &s = state.c_updates_state();
+			setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
 
-		auto &s = d.vintermediate_state().c_updates_state();
-		setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
-
-		_ptsWaiter.setRequesting(false);
+			_ptsWaiter.setRequesting(false);
 
-		MTP_LOG(0, ("getDifference "
-			"{ good - after a slice of difference was received }%1"
-			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
-		getDifference();
+			MTP_LOG(0, ("getDifference "
+				"{ good - after a slice of difference was received }%1"
+				).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
+			getDifference();
+		});
 	} break;
 	case mtpc_updates_difference: {
 		auto &d = result.c_updates_difference();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		stateDone(d.vstate());
+		const auto state = d.vstate();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			stateDone(state);
+		});
 	} break;
 	case mtpc_updates_differenceTooLong: {
 		LOG(("API Error: updates.differenceTooLong is not supported by Telegram Desktop!"));
@@ -573,13 +638,104 @@ void Updates::feedDifference(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other) {
+		const MTPVector<MTPUpdate> &other,
+		Fn<void()> done) {
 	Core::App().checkAutoLock();
-	session().data().processUsers(users);
-	session().data().processChats(chats);
-	feedMessageIds(other);
-	session().data().processMessages(msgs, NewMessageType::Unread);
-	feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+
+	// Requesting state is kept until done() is called,
+	// so other updates wait for this difference to be applied.
+	_differenceApplying = true;
+	const auto weak = base::make_weak(_session.get());
+	const auto started = crl::now();
+	crl::async([=, users = users.v, chats = chats.v, msgs = msgs.v, other = other.v] {
+		auto prepared = std::make_shared<PreparedDifference>();
+		auto &duplicates = prepared->duplicates;
+		prepared->users = RemoveExactDuplicates(users, duplicates);
+		prepared->chats = RemoveExactDuplicates(chats, duplicates);
+		prepared->messages = SortMessagesById(
+			RemoveExactDuplicates(msgs, duplicates));
+		for (const auto &update : other) {
+			if (update.type() == mtpc_updateMessageID) {
+				prepared->messageIds.push_back(update);
+			} else {
+				prepared->other.push_back(update);
+			}
+		}
+		const auto duration = crl::now() - started;
+		crl::on_main(weak, [=] {
+			DEBUG_LOG(("API Info: getDifference prepared in %1ms, "
+				"%2 users, %3 chats, %4 messages, %5 updates, "
+				"%6 duplicates."
+				).arg(duration
+				).arg(prepared->users.size()
+				).arg(prepared->chats.size()
+				).arg(prepared->messages.size()
+				).arg(prepared->messageIds.size() + prepared->other.size()
+				).arg(prepared->duplicates));
+			applyDifference(prepared, done);
+		});
+	});
+}
+
+void Updates::applyDifference(
+		std::shared_ptr<PreparedDifference> prepared,
+		Fn<void()> done) {
+	const auto started = crl::now();
+	session().data().processUsers(
+		MTP_vector<MTPUser>(base::take(prepared->users)));
+	const auto users = crl::now();
+	session().data().processChats(
+		MTP_vector<MTPChat>(base::take(prepared->chats)));
+	const auto chats = crl::now();
+	feedMessageIds(MTP_vector<MTPUpdate>(base::take(prepared->messageIds)));
+	const auto messageIds = crl::now();
+	DEBUG_LOG(("API Info: getDifference users in %1ms, chats in %2ms, "
+		"message ids in %3ms."
+		).arg(users - started
+		).arg(chats - users
+		).arg(messageIds - chats));
+
+	applyDifferenceMessages(std::move(prepared), std::move(done));
+}
+
+void Updates::applyDifferenceMessages(
+		std::shared_ptr<PreparedDifference> prepared,
+		Fn<void()> done) {
+	const auto started = crl::now();
+	const auto &messages = prepared->messages;
+	auto &added = prepared->messagesAdded;
+	while (added < messages.size()) {
+		const auto count = std::min(
+			kDifferenceMessagesStep,
+			int(messages.size()) - added);
+		session().data().processMessages(
+			messages.mid(added, count),
+			NewMessageType::Unread);
+		added += count;
+		if (added < messages.size()
+			&& crl::now() - started >= kDifferenceMessagesStepTime) {
+			prepared->messagesDuration += crl::now() - started;
+			crl::on_main(_session, [=] {
+				applyDifferenceMessages(prepared, done);
+			});
+			return;
+		}
+	}
+	const auto updates = crl::now();
+	prepared->messagesDuration += updates - started;
+	feedUpdateVector(
+		MTP_vector<MTPUpdate>(base::take(prepared->other)),
+		SkipUpdatePolicy::SkipMessageIds);
+	DEBUG_LOG(("API Info: getDifference messages in %1ms, "
+		"updates in %2ms."
+		).arg(prepared->messagesDuration
+		).arg(crl::now() - updates));
+
+	_differenceApplying = false;
+	done();
+	for (const auto &queued : base::take(_differenceApplyingQueue)) {
+		applyReceivedUpdates(queued);
+	}
 }
 
 void Updates::differenceFail(const MTP::Error &error) {
@@ -833,6 +989,14 @@ void Updates::mtpUpdateReceived(const MTPUpdates &updates) {
 	Core::App().checkAutoLock();
 	_lastUpdateTime = crl::now();
 	_noUpdatesTimer.callOnce(kNoUpdatesTimeout);
+	if (_differenceApplying && !HasForceLogoutNotification(updates)) {
+		_differenceApplyingQueue.push_back(updates);
+	} else {
+		applyReceivedUpdates(updates);
+	}
+}
+
+void Updates::applyReceivedUpdates(const MTPUpdates &updates) {
 	if (!requestingDifference()
 		|| HasForceLogoutNotification(updates)) {
 		applyUpdates(updates);
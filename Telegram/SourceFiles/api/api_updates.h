@@ -82,6 +82,8 @@ private:
 		rpl::lifetime lifetime;
 	};
 
+	struct PreparedDifference;
+
 	void channelRangeDifferenceSend(
 		not_null<ChannelData*> channel,
 		MsgRange range,
@@ -108,7 +110,8 @@ private:
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other);
+		const MTPVector<MTPUpdate> &other,
+		Fn<void()> done);
 	void stateDone(const MTPupdates_State &state);
 	void setState(int32 pts, int32 date, int32 qts, int32 seq);
 	void channelDifferenceDone(
@@ -121,6 +124,7 @@ private:
 	void feedChannelDifference(const MTPDupdates_channelDifference &data);
 
 	void mtpUpdateReceived(const MTPUpdates &updates);
+	void applyReceivedUpdates(const MTPUpdates &updates);
 	void mtpNewSessionCreated();
 	void feedUpdateVector(
 		const MTPVector<MTPUpdate> &updates,
@@ -132,6 +136,14 @@ private:
 
 	void applyGroupCallParticipantUpdates(const MTPUpdates &updates);
 
+	// Main thread part of feedDifference(), after PrepareDifference().
+	void applyDifference(
+		std::shared_ptr<PreparedDifference> prepared,
+		Fn<void()> done);
+	void applyDifferenceMessages(
+		std::shared_ptr<PreparedDifference> prepared,
+		Fn<void()> done);
+
 	bool whenGetDiffChanged(
 		ChannelData *channel,
 		int32 ms,
@@ -196,6 +208,11 @@ private:
 	crl::time _lastUpdateTime = 0;
 	bool _handlingChannelDifference = false;
 
+	// Updates received while a difference is being applied are not
+	// in it, they're applied when the difference is applied.
+	std::vector<MTPUpdates> _differenceApplyingQueue;
+	bool _differenceApplying = false;
+
 	base::flat_map<int, ActiveChatTracker> _activeChats;
 	base::flat_map<
 		not_null<PeerData*>,
@@ -24,6 +24,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_updates.h"
 #include "api/api_user_privacy.h"
 #include "api/api_views.h"
+#include "api/api_search_cache.h"
 #include "api/api_confirm_phone.h"
 #include "data/stickers/data_stickers.h"
 #include "data/data_drafts.h"
@@ -150,7 +151,8 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 , _views(std::make_unique<Api::ViewsManager>(this))
 , _confirmPhone(std::make_unique<Api::ConfirmPhone>(this))
 , _peerPhoto(std::make_unique<Api::PeerPhoto>(this))
-, _polls(std::make_unique<Api::Polls>(this)) {
+, _polls(std::make_unique<Api::Polls>(this))
+, _searchCache(std::make_unique<Api::SearchResultsCache>(this)) {
 	crl::on_main(session, [=] {
 		// You can't use _session->lifetime() in the constructor,
 		// only queued, because it is not constructed yet.
@@ -1824,7 +1826,10 @@ void ApiWrap::requestStickerSets() {
 		++j;
 		if (i.value().second) continue;
 
-		auto waitMs = (j == e) ? 0 : kSmallDelayMs;
+		// The last request of the burst flushes the batch right away.
+		const auto priority = (j == e)
+			? MTP::RequestPriority::Interactive
+			: MTP::RequestPriority::Background;
 		const auto id = MTP_inputStickerSetID(
 			MTP_long(i.key()),
 			MTP_long(i.value().first));
@@ -1834,7 +1839,7 @@ void ApiWrap::requestStickerSets() {
 			gotStickerSet(setId, result);
 		}).fail([=, setId = i.key()](const MTP::Error &error) {
 			_stickerSetRequests.remove(setId);
-		}).afterDelay(waitMs).send();
+		}).priority(priority).send();
 	}
 }
 
@@ -4645,3 +4650,7 @@ Api::PeerPhoto &ApiWrap::peerPhoto() {
 Api::Polls &ApiWrap::polls() {
 	return *_polls;
 }
+
+Api::SearchResultsCache &ApiWrap::searchCache() {
+	return *_searchCache;
+}
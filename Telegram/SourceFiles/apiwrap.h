@@ -66,6 +66,7 @@ class ViewsManager;
 class ConfirmPhone;
 class PeerPhoto;
 class Polls;
+class SearchResultsCache;
 
 namespace details {
 
@@ -401,6 +402,7 @@ public:
 	[[nodiscard]] Api::ConfirmPhone &confirmPhone();
 	[[nodiscard]] Api::PeerPhoto &peerPhoto();
 	[[nodiscard]] Api::Polls &polls();
+	[[nodiscard]] Api::SearchResultsCache &searchCache();
 
 	void updatePrivacyLastSeens();
 
@@ -708,6 +710,7 @@ private:
 	const std::unique_ptr<Api::ConfirmPhone> _confirmPhone;
 	const std::unique_ptr<Api::PeerPhoto> _peerPhoto;
 	const std::unique_ptr<Api::Polls> _polls;
+	const std::unique_ptr<Api::SearchResultsCache> _searchCache;
 
 	mtpRequestId _wallPaperRequestId = 0;
 	QString _wallPaperSlug;
@@ -270,7 +270,8 @@ LocalStorageBox::LocalStorageBox(
 	CreateTag)
 : _session(session)
 , _db(&session->data().cache())
-, _dbBig(&session->data().cacheBigFile()) {
+, _dbBig(&session->data().cacheBigFile())
+, _dbBigTag(session->data().cacheBigFileTag()) {
 	const auto &settings = session->local().cacheSettings();
 	const auto &settingsBig = session->local().cacheBigFileSettings();
 	_totalSizeLimit = settings.totalSizeLimit + settingsBig.totalSizeLimit;
@@ -325,7 +326,8 @@ void LocalStorageBox::update(
 	}
 	for (const auto &entry : _rows) {
 		if (entry.first == kFakeMediaCacheTag) {
-			updateRow(entry.second, &_statsBig.full);
+			const auto big = summaryBig();
+			updateRow(entry.second, &big);
 		} else if (entry.first) {
 			const auto i = _stats.tagged.find(entry.first);
 			updateRow(
@@ -339,20 +341,40 @@ void LocalStorageBox::update(
 }
 
 auto LocalStorageBox::summary() const -> Database::TaggedSummary {
+	const auto big = summaryBig();
 	auto result = _stats.full;
-	result.count += _statsBig.full.count;
-	result.totalSize += _statsBig.full.totalSize;
+	result.count += big.count;
+	result.totalSize += big.totalSize;
 	return result;
 }
 
+auto LocalStorageBox::summaryBig() const -> Database::TaggedSummary {
+	if (!_dbBigTag) {
+		return _statsBig.full;
+	}
+	// The media cache is shared, show only what this account has put.
+	const auto i = _statsBig.tagged.find(_dbBigTag);
+	return (i != end(_statsBig.tagged))
+		? i->second
+		: Database::TaggedSummary();
+}
+
+void LocalStorageBox::clearBig() {
+	if (_dbBigTag) {
+		_dbBig->clearByTag(_dbBigTag);
+	} else {
+		_dbBig->clear();
+	}
+}
+
 void LocalStorageBox::clearByTag(uint16 tag) {
 	if (tag == kFakeMediaCacheTag) {
-		_dbBig->clear();
+		clearBig();
 	} else if (tag) {
 		_db->clearByTag(tag);
 	} else {
 		_db->clear();
-		_dbBig->clear();
+		clearBig();
 		Ui::Emoji::ClearIrrelevantCache();
 	}
 }
@@ -422,7 +444,7 @@ void LocalStorageBox::setupControls() {
 		kFakeMediaCacheTag,
 		std::move(mediaCacheTitle),
 		tr::lng_local_storage_clear_some(),
-		_statsBig.full));
+		summaryBig()));
 	shadow->toggleOn(
 		std::move(tracker).atLeastOneShownValue()
 	);
@@ -592,6 +614,7 @@ void LocalStorageBox::save() {
 	updateBig.totalTimeLimit = _timeLimit;
 	_session->local().updateCacheSettings(update, updateBig);
 	_session->data().cache().updateSettings(update);
+	_session->data().updateCacheBigFileSettings(updateBig);
 	closeBox();
 }
 
@@ -65,6 +65,8 @@ private:
 	void save();
 
 	Database::TaggedSummary summary() const;
+	Database::TaggedSummary summaryBig() const;
+	void clearBig();
 
 	template <
 		typename Value,
@@ -86,6 +88,7 @@ private:
 	const not_null<Main::Session*> _session;
 	const not_null<Storage::Cache::Database*> _db;
 	const not_null<Storage::Cache::Database*> _dbBig;
+	const uint8 _dbBigTag = 0;
 
 	Database::Stats _stats;
 	Database::Stats _statsBig;
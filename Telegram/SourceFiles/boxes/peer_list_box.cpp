@@ -32,6 +32,26 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <rpl/range.h>
 
+namespace {
+
+[[nodiscard]] bool AllSearchWordsInNames(
+		not_null<PeerData*> peer,
+		const QStringList &searchWords) {
+	const auto &nameWords = peer->nameWords();
+	for (const auto &searchWord : searchWords) {
+		const auto found = ranges::any_of(nameWords, [&](
+				const QString &nameWord) {
+			return nameWord.startsWith(searchWord);
+		});
+		if (!found) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
 PaintRoundImageCallback PaintUserpicCallback(
 		not_null<PeerData*> peer,
 		bool respectSavedMessagesChat) {
@@ -925,29 +945,73 @@ void PeerListContent::addToSearchIndex(not_null<PeerListRow*> row) {
 	}
 
 	removeFromSearchIndex(row);
-	row->setNameFirstLetters(row->peer()->nameFirstLetters());
-	for (auto ch : row->nameFirstLetters()) {
-		_searchIndex[ch].push_back(row);
+	const auto &words = row->peer()->nameWords();
+	row->setIndexedNameWords(words);
+	for (const auto &word : words) {
+		_searchIndex.emplace(word, row.get());
 	}
+	++_searchIndexVersion;
 }
 
 void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
-	const auto &nameFirstLetters = row->nameFirstLetters();
-	if (!nameFirstLetters.empty()) {
-		for (auto ch : row->nameFirstLetters()) {
-			auto it = _searchIndex.find(ch);
-			if (it != _searchIndex.cend()) {
-				auto &entry = it->second;
-				entry.erase(ranges::remove(entry, row), end(entry));
-				if (entry.empty()) {
-					_searchIndex.erase(it);
-				}
-			}
+	const auto &words = row->indexedNameWords();
+	if (!words.empty()) {
+		for (const auto &word : words) {
+			_searchIndex.erase(std::make_pair(word, row.get()));
 		}
-		row->setNameFirstLetters({});
+		row->setIndexedNameWords({});
 	}
 }
 
+std::vector<not_null<PeerListRow*>> PeerListContent::searchInIndex(
+		const QStringList &searchWords) const {
+	Expects(!searchWords.isEmpty());
+
+	// The longest word usually has the narrowest prefix range.
+	const auto &longest = *ranges::max_element(
+		searchWords,
+		std::less<>(),
+		&QString::size);
+	auto result = std::vector<not_null<PeerListRow*>>();
+	const auto from = _searchIndex.lower_bound(
+		std::make_pair(longest, (PeerListRow*)nullptr));
+	for (auto i = from; i != end(_searchIndex); ++i) {
+		if (!i->first.startsWith(longest)) {
+			break;
+		}
+		result.push_back(i->second);
+	}
+	ranges::sort(result, std::less<>(), &PeerListRow::absoluteIndex);
+	result.erase(std::unique(begin(result), end(result)), end(result));
+	if (searchWords.size() > 1) {
+		result.erase(ranges::remove_if(result, [&](
+				not_null<PeerListRow*> row) {
+			return !AllSearchWordsInNames(row->peer(), searchWords);
+		}), end(result));
+	}
+	return result;
+}
+
+bool PeerListContent::canRefineFilterResults(
+		const QStringList &searchWords) const {
+	if (_filterResultsWords.isEmpty()
+		|| _filterResultsIndexVersion != _searchIndexVersion) {
+		return false;
+	}
+	// Each row matching the new words matches the old ones as well,
+	// if every old word is a prefix of some new word.
+	for (const auto &word : _filterResultsWords) {
+		const auto extended = ranges::any_of(searchWords, [&](
+				const QString &searchWord) {
+			return searchWord.startsWith(word);
+		});
+		if (!extended) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void PeerListContent::prependRow(std::unique_ptr<PeerListRow> row) {
 	Expects(row != nullptr);
 
@@ -1046,6 +1110,7 @@ void PeerListContent::clearAllContent() {
 	_rowsById.clear();
 	_rowsByPeer.clear();
 	_filterResults.clear();
+	_filterResultsWords = QStringList();
 	_searchIndex.clear();
 	_rows.clear();
 	_searchRows.clear();
@@ -1716,50 +1781,32 @@ void PeerListContent::searchQueryChanged(QString query) {
 	const auto searchWordsList = TextUtilities::PrepareSearchWords(query);
 	const auto normalizedQuery = searchWordsList.join(' ');
 	if (_normalizedSearchQuery != normalizedQuery) {
-		setSearchQuery(query, normalizedQuery);
-		if (_controller->searchInLocal() && !searchWordsList.isEmpty()) {
-			Assert(_hiddenRows.empty());
-
-			auto minimalList = (const std::vector<not_null<PeerListRow*>>*)nullptr;
-			for (const auto &searchWord : searchWordsList) {
-				auto searchWordStart = searchWord[0].toLower();
-				auto it = _searchIndex.find(searchWordStart);
-				if (it == _searchIndex.cend()) {
-					// Some word can't be found in any row.
-					minimalList = nullptr;
-					break;
-				} else if (!minimalList || minimalList->size() > it->second.size()) {
-					minimalList = &it->second;
+		const auto searchLocal = _controller->searchInLocal()
+			&& !searchWordsList.isEmpty();
+
+		// Typing one more letter only narrows the previous results,
+		// so there is no need to go through the index again.
+		auto refined = std::optional<std::vector<not_null<PeerListRow*>>>();
+		if (searchLocal && canRefineFilterResults(searchWordsList)) {
+			refined.emplace();
+			refined->reserve(_filterResults.size());
+			for (const auto &row : _filterResults) {
+				if (!row->isSearchResult()
+					&& !row->special()
+					&& AllSearchWordsInNames(row->peer(), searchWordsList)) {
+					refined->push_back(row);
 				}
 			}
-			if (minimalList) {
-				auto searchWordInNames = [](
-						not_null<PeerData*> peer,
-						const QString &searchWord) {
-					for (auto &nameWord : peer->nameWords()) {
-						if (nameWord.startsWith(searchWord)) {
-							return true;
-						}
-					}
-					return false;
-				};
-				auto allSearchWordsInNames = [&](
-						not_null<PeerData*> peer) {
-					for (const auto &searchWord : searchWordsList) {
-						if (!searchWordInNames(peer, searchWord)) {
-							return false;
-						}
-					}
-					return true;
-				};
+		}
+		setSearchQuery(query, normalizedQuery);
+		if (searchLocal) {
+			Assert(_hiddenRows.empty());
 
-				_filterResults.reserve(minimalList->size());
-				for (const auto &row : *minimalList) {
-					if (!row->special() && allSearchWordsInNames(row->peer())) {
-						_filterResults.push_back(row);
-					}
-				}
-			}
+			_filterResults = refined
+				? std::move(*refined)
+				: searchInIndex(searchWordsList);
+			_filterResultsWords = searchWordsList;
+			_filterResultsIndexVersion = _searchIndexVersion;
 		}
 		if (_controller->hasComplexSearch()) {
 			_controller->search(_searchQuery);
@@ -1826,6 +1873,7 @@ void PeerListContent::setSearchQuery(
 		? _searchQuery.mid(1)
 		: _searchQuery;
 	_filterResults.clear();
+	_filterResultsWords = QStringList();
 	clearSearchRows();
 }
 
@@ -214,11 +214,11 @@ public:
 		int outerWidth);
 	float64 checkedRatio();
 
-	void setNameFirstLetters(const base::flat_set<QChar> &firstLetters) {
-		_nameFirstLetters = firstLetters;
+	void setIndexedNameWords(const base::flat_set<QString> &words) {
+		_indexedNameWords = words;
 	}
-	const base::flat_set<QChar> &nameFirstLetters() const {
-		return _nameFirstLetters;
+	const base::flat_set<QString> &indexedNameWords() const {
+		return _indexedNameWords;
 	}
 
 	virtual void lazyInitialize(const style::PeerListItem &st);
@@ -260,7 +260,7 @@ private:
 	Ui::Text::String _status;
 	StatusType _statusType = StatusType::Online;
 	crl::time _statusValidTill = 0;
-	base::flat_set<QChar> _nameFirstLetters;
+	base::flat_set<QString> _indexedNameWords;
 	int _absoluteIndex = -1;
 	State _disabledState = State::Active;
 	bool _hidden : 1;
@@ -621,9 +621,6 @@ public:
 	template <typename ReorderCallback>
 	void reorderRows(ReorderCallback &&callback) {
 		callback(_rows.begin(), _rows.end());
-		for (auto &searchEntity : _searchIndex) {
-			callback(searchEntity.second.begin(), searchEntity.second.end());
-		}
 		refreshIndices();
 		if (!_hiddenRows.empty()) {
 			callback(_filterResults.begin(), _filterResults.end());
@@ -745,6 +742,10 @@ private:
 	void addToSearchIndex(not_null<PeerListRow*> row);
 	bool addingToSearchIndex() const;
 	void removeFromSearchIndex(not_null<PeerListRow*> row);
+	[[nodiscard]] std::vector<not_null<PeerListRow*>> searchInIndex(
+		const QStringList &searchWords) const;
+	[[nodiscard]] bool canRefineFilterResults(
+		const QStringList &searchWords) const;
 	void setSearchQuery(const QString &query, const QString &normalizedQuery);
 	bool showingSearch() const {
 		return !_hiddenRows.empty() || !_searchQuery.isEmpty();
@@ -788,9 +789,13 @@ private:
 	std::map<PeerListRowId, not_null<PeerListRow*>> _rowsById;
 	std::map<PeerData*, std::vector<not_null<PeerListRow*>>> _rowsByPeer;
 
-	std::map<QChar, std::vector<not_null<PeerListRow*>>> _searchIndex;
+	// Sorted (name word, row) pairs, a prefix lookup is a range scan.
+	std::set<std::pair<QString, PeerListRow*>> _searchIndex;
+	int _searchIndexVersion = 0;
 	QString _searchQuery;
 	QString _normalizedSearchQuery;
+	QStringList _filterResultsWords;
+	int _filterResultsIndexVersion = -1;
 	QString _mentionHighlight;
 	std::vector<not_null<PeerListRow*>> _filterResults;
 	base::flat_set<not_null<PeerListRow*>> _hiddenRows;
@@ -15,13 +15,66 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_file_origin.h"
 #include "storage/cache/storage_cache_database.h"
+#include "storage/file_download.h" // Storage::kMaxFileInMemory.
 #include "ui/effects/path_shift_gradient.h"
 #include "main/main_session.h"
 
 namespace ChatHelpers {
 namespace {
 
-constexpr auto kDontCacheLottieAfterArea = 512 * 512;
+// Frames of large animations take a lot of the cacheBigFile() space,
+// they are still cached and evicted by its size limit like other files.
+constexpr auto kLargeLottieArea = 512 * 512;
+constexpr auto kDontCacheLottieAfterArea = 1280 * 1280;
+
+// Lottie::SinglePlayer keeps this many prepared frames.
+constexpr auto kSinglePlayerFramesCount = 4;
+
+struct SharedPlayerKey {
+	not_null<DocumentData*> document;
+	uint8 keyShift = 0;
+	int width = 0;
+	int height = 0;
+	Lottie::Quality quality = Lottie::Quality();
+
+	friend inline bool operator<(
+			const SharedPlayerKey &a,
+			const SharedPlayerKey &b) {
+		return std::tie(a.document, a.keyShift, a.width, a.height, a.quality)
+			< std::tie(b.document, b.keyShift, b.width, b.height, b.quality);
+	}
+};
+
+struct SharedPlayer {
+	std::weak_ptr<Lottie::SinglePlayer> player;
+	Lottie::SinglePlayer *raw = nullptr;
+	int shownFrameIndex = -1;
+	rpl::lifetime lifetime;
+};
+
+struct SharedPlayersStats {
+	int64 savedPlayers = 0;
+	int64 savedRenders = 0;
+	int64 savedBytes = 0;
+};
+
+// Entries are removed when the last view releases the player,
+// so a key never outlives its document or its session.
+base::flat_map<SharedPlayerKey, SharedPlayer> SharedPlayers;
+base::flat_map<not_null<Lottie::SinglePlayer*>, SharedPlayerKey> SharedKeys;
+SharedPlayersStats SharedStats;
+
+// The cacheBigFile() rejects values larger than Storage::kMaxFileInMemory.
+// The size of the frames cache depends on the content, so it is known only
+// after the first encoding. Those keys don't use the frames cache anymore,
+// so that the encoding cost is not paid again for nothing.
+base::flat_set<Storage::Cache::Key> TooLargeToCache;
+
+[[nodiscard]] Storage::Cache::Key LottieCacheKey(
+		Storage::Cache::Key baseKey,
+		uint8 keyShift) {
+	return Storage::Cache::Key{ baseKey.high, baseKey.low + keyShift };
+}
 
 } // namespace
 
@@ -33,19 +86,34 @@ auto LottieCachedFromContent(
 		not_null<Main::Session*> session,
 		const QByteArray &content,
 		QSize box) {
-	const auto key = Storage::Cache::Key{
-		baseKey.high,
-		baseKey.low + keyShift
-	};
+	const auto key = LottieCacheKey(baseKey, keyShift);
 	const auto get = [=](FnMut<void(QByteArray &&cached)> handler) {
 		session->data().cacheBigFile().get(
 			key,
 			std::move(handler));
 	};
 	const auto weak = base::make_weak(session.get());
+	const auto large = (box.width() * box.height()) > kLargeLottieArea;
 	const auto put = [=](QByteArray &&cached) {
 		crl::on_main(weak, [=, data = std::move(cached)]() mutable {
-			weak->data().cacheBigFile().put(key, std::move(data));
+			if (data.size() > Storage::kMaxFileInMemory) {
+				DEBUG_LOG(("Lottie: Not caching %1x%2 frames, %3 KB."
+					).arg(box.width()
+					).arg(box.height()
+					).arg(data.size() / 1024));
+				TooLargeToCache.emplace(key);
+				return;
+			} else if (large) {
+				DEBUG_LOG(("Lottie: Caching %1x%2 frames, %3 KB."
+					).arg(box.width()
+					).arg(box.height()
+					).arg(data.size() / 1024));
+			}
+			weak->data().cacheBigFile().put(
+				key,
+				Storage::Cache::Database::TaggedValue(
+					std::move(data),
+					weak->data().cacheBigFileTag()));
 		});
 	};
 	return method(
@@ -65,12 +133,14 @@ auto LottieFromDocument(
 	const auto data = media->bytes();
 	const auto filepath = document->filepath();
 	if (box.width() * box.height() > kDontCacheLottieAfterArea) {
-		// Don't use frame caching for large stickers.
+		// Don't use frame caching for very large stickers.
 		return method(
 			Lottie::ReadContent(data, filepath),
 			Lottie::FrameRequest{ box });
 	}
-	if (const auto baseKey = document->bigFileBaseCacheKey()) {
+	const auto baseKey = document->bigFileBaseCacheKey();
+	if (baseKey
+		&& !TooLargeToCache.contains(LottieCacheKey(baseKey, keyShift))) {
 		return LottieCachedFromContent(
 			std::forward<Method>(method),
 			baseKey,
@@ -118,6 +188,93 @@ std::unique_ptr<Lottie::SinglePlayer> LottiePlayerFromDocument(
 	return LottieFromDocument(method, media, uint8(keyShift), box);
 }
 
+std::shared_ptr<Lottie::SinglePlayer> LottieSharedPlayerFromDocument(
+		not_null<Data::DocumentMedia*> media,
+		const Lottie::ColorReplacements *replacements,
+		StickerLottieSize sizeTag,
+		QSize box,
+		Lottie::Quality quality) {
+	const auto tag = replacements ? replacements->tag : uint8(0);
+	const auto key = SharedPlayerKey{
+		.document = media->owner(),
+		.keyShift = uint8(((tag << 4) & 0xF0) | (uint8(sizeTag) & 0x0F)),
+		.width = box.width(),
+		.height = box.height(),
+		.quality = quality,
+	};
+	const auto i = SharedPlayers.find(key);
+	if (i != end(SharedPlayers)) {
+		if (auto result = i->second.player.lock()) {
+			const auto frameBytes = int64(box.width()) * box.height() * 4;
+			++SharedStats.savedPlayers;
+			SharedStats.savedBytes += frameBytes * kSinglePlayerFramesCount;
+			DEBUG_LOG(("Lottie: Shared player for %1 used by %2 views, "
+				"saved %3 players, %4 renders, %5 KB so far."
+				).arg(key.document->id
+				).arg(result.use_count() - 1
+				).arg(SharedStats.savedPlayers
+				).arg(SharedStats.savedRenders
+				).arg(SharedStats.savedBytes / 1024));
+			return result;
+		}
+	}
+
+	const auto raw = LottiePlayerFromDocument(
+		media,
+		replacements,
+		sizeTag,
+		box,
+		quality).release();
+	const auto destroy = [=](Lottie::SinglePlayer *player) {
+		const auto i = SharedPlayers.find(key);
+		if (i != end(SharedPlayers) && i->second.raw == player) {
+			SharedPlayers.erase(i);
+		}
+		SharedKeys.remove(player);
+		delete player;
+	};
+	auto result = std::shared_ptr<Lottie::SinglePlayer>(raw, destroy);
+	auto &entry = SharedPlayers[key];
+	entry.player = result;
+	entry.raw = raw;
+	entry.shownFrameIndex = -1;
+	entry.lifetime.destroy();
+	SharedKeys.emplace(raw, key);
+	result->updates(
+	) | rpl::start_with_next([=](Lottie::Update update) {
+		if (v::is<Lottie::DisplayFrameRequest>(update.data)) {
+			const auto i = SharedPlayers.find(key);
+			if (i != end(SharedPlayers)) {
+				if (const auto strong = i->second.player.lock()) {
+					// One reference is held by the strong pointer here.
+					const auto consumers = strong.use_count() - 1;
+					if (strong.get() == raw && consumers > 1) {
+						SharedStats.savedRenders += consumers - 1;
+					}
+				}
+			}
+		}
+	}, entry.lifetime);
+	return result;
+}
+
+bool LottieSharedPlayerMarkFrameShown(
+		not_null<Lottie::SinglePlayer*> player,
+		int frameIndex) {
+	const auto k = SharedKeys.find(player);
+	const auto i = (k != end(SharedKeys))
+		? SharedPlayers.find(k->second)
+		: end(SharedPlayers);
+	if (i == end(SharedPlayers) || i->second.raw != player) {
+		return player->markFrameShown();
+	} else if (i->second.shownFrameIndex == frameIndex
+		|| !player->markFrameShown()) {
+		return false;
+	}
+	i->second.shownFrameIndex = frameIndex;
+	return true;
+}
+
 not_null<Lottie::Animation*> LottieAnimationFromDocument(
 		not_null<Lottie::MultiPlayer*> player,
 		not_null<Data::DocumentMedia*> media,
@@ -63,6 +63,22 @@ enum class StickerLottieSize : uchar {
 	QSize box,
 	Lottie::Quality quality = Lottie::Quality(),
 	std::shared_ptr<Lottie::FrameRenderer> renderer = nullptr);
+
+// Views showing the same document with the same size and replacements
+// share a single player, each frame is rendered once for all of them.
+// They must request frames with the same Lottie::FrameRequest.
+[[nodiscard]] std::shared_ptr<Lottie::SinglePlayer> LottieSharedPlayerFromDocument(
+	not_null<Data::DocumentMedia*> media,
+	const Lottie::ColorReplacements *replacements,
+	StickerLottieSize sizeTag,
+	QSize box,
+	Lottie::Quality quality = Lottie::Quality());
+
+// Only the first of the views sharing a player that shows a frame
+// marks it as shown, the others just paint it.
+bool LottieSharedPlayerMarkFrameShown(
+	not_null<Lottie::SinglePlayer*> player,
+	int frameIndex);
 [[nodiscard]] not_null<Lottie::Animation*> LottieAnimationFromDocument(
 	not_null<Lottie::MultiPlayer*> player,
 	not_null<Data::DocumentMedia*> media,
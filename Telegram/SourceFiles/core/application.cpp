@@ -23,6 +23,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/local_url_handlers.h"
 #include "core/launcher.h"
 #include "core/ui_integration.h"
+#include "core/core_startup_trace.h"
 #include "chat_helpers/emoji_keywords.h"
 #include "chat_helpers/stickers_emoji_image_loader.h"
 #include "base/qt_adapters.h"
@@ -205,8 +206,12 @@ Application::~Application() {
 }
 
 void Application::run() {
+	StartupTrace::Start();
+
+	StartupTrace::Step("fonts");
 	style::internal::StartFonts();
 
+	StartupTrace::Step("third party");
 	ThirdParty::start();
 	refreshGlobalProxy(); // Depends on Core::IsAppLaunched().
 
@@ -214,6 +219,7 @@ void Application::run() {
 	// Depends on notifications settings.
 	_notifications = std::make_unique<Window::Notifications::System>();
 
+	StartupTrace::Step("local storage");
 	startLocalStorage();
 	ValidateScale();
 
@@ -235,12 +241,17 @@ void Application::run() {
 	_translator = std::make_unique<Lang::Translator>();
 	QCoreApplication::instance()->installTranslator(_translator.get());
 
+	StartupTrace::Step("style");
 	style::startManager(cScale());
 	Ui::InitTextOptions();
 	Ui::StartCachedCorners();
+
+	StartupTrace::Step("emoji");
 	Ui::Emoji::Init();
 	startEmojiImageLoader();
 	startSystemDarkModeViewer();
+
+	StartupTrace::Step("audio");
 	Media::Player::start(_audio.get());
 
 	style::ShortAnimationPlaying(
@@ -260,8 +271,16 @@ void Application::run() {
 	DEBUG_LOG(("Application Info: starting app..."));
 
 	// Create mime database, so it won't be slow later.
-	QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+	StartupTrace::Step("mime database");
+	if (cDeferredInit()) {
+		crl::async([] {
+			QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+		});
+	} else {
+		QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+	}
 
+	StartupTrace::Step("window");
 	_window = std::make_unique<Window::Controller>();
 
 	_domain->activeChanges(
@@ -283,16 +302,22 @@ void Application::run() {
 	DEBUG_LOG(("Application Info: window created..."));
 
 	// Depend on activeWindow() for now :(
+	StartupTrace::Step("shortcuts");
 	startShortcuts();
+
+	StartupTrace::Step("domain");
 	startDomain();
 
+	StartupTrace::Step("show");
 	_window->widget()->show();
 
-	const auto currentGeometry = _window->widget()->geometry();
-	_mediaView = std::make_unique<Media::View::OverlayWidget>();
-	_window->widget()->Ui::RpWidget::setGeometry(currentGeometry);
+	if (!cDeferredInit()) {
+		StartupTrace::Step("media viewer");
+		startMediaView();
+	}
 
 	DEBUG_LOG(("Application Info: showing."));
+	StartupTrace::Step("first show");
 	_window->finishFirstShow();
 
 	if (!_window->locked() && cStartToSettings()) {
@@ -312,18 +337,54 @@ void Application::run() {
 
 	_window->openInMediaViewRequests(
 	) | rpl::start_with_next([=](Media::View::OpenRequest &&request) {
-		if (_mediaView) {
-			_mediaView->show(std::move(request));
-		}
+		startMediaView();
+		_mediaView->show(std::move(request));
 	}, _window->lifetime());
 
-	{
-		const auto countries = std::make_shared<Countries::Manager>(
-			_domain.get());
-		countries->lifetime().add([=] {
-			[[maybe_unused]] const auto countriesCopy = countries;
-		});
+	if (!cDeferredInit()) {
+		StartupTrace::Step("countries");
+		startCountries();
+		StartupTrace::Finish();
+		return;
+	}
+	StartupTrace::Step(nullptr);
+
+	// Start the rest after the queued first paint of the window.
+	crl::on_main(this, [=] {
+		if (!_window) {
+			return;
+		}
+		{
+			const auto trace = StartupTrace::Scope("media viewer (deferred)");
+			startMediaView();
+		}
+		{
+			const auto trace = StartupTrace::Scope("countries (deferred)");
+			startCountries();
+		}
+		StartupTrace::Finish();
+	});
+}
+
+void Application::startMediaView() {
+	Expects(_window != nullptr);
+
+	if (_mediaView) {
+		return;
 	}
+
+	// Creating the media viewer may change the main window geometry.
+	const auto currentGeometry = _window->widget()->geometry();
+	_mediaView = std::make_unique<Media::View::OverlayWidget>();
+	_window->widget()->Ui::RpWidget::setGeometry(currentGeometry);
+}
+
+void Application::startCountries() {
+	const auto countries = std::make_shared<Countries::Manager>(
+		_domain.get());
+	countries->lifetime().add([=] {
+		[[maybe_unused]] const auto countriesCopy = countries;
+	});
 }
 
 void Application::showOpenGLCrashNotification() {
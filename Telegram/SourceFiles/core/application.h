@@ -287,6 +287,8 @@ private:
 	void startLocalStorage();
 	void startShortcuts();
 	void startDomain();
+	void startMediaView();
+	void startCountries();
 	void startEmojiImageLoader();
 	void startSystemDarkModeViewer();
 
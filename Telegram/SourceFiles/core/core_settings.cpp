@@ -124,7 +124,7 @@ QByteArray Settings::serialize() const {
 		+ Serialize::bytearraySize(proxy)
 		+ sizeof(qint32) * 2
 		+ Serialize::bytearraySize(_photoEditorBrush)
-		+ sizeof(qint32);
+		+ sizeof(qint32) * 5;
 
 	auto result = QByteArray();
 	result.reserve(size);
@@ -221,7 +221,9 @@ QByteArray Settings::serialize() const {
 			<< _photoEditorBrush
 			<< qint32(_groupCallNoiseSuppression ? 1 : 0)
 			<< qint32(_voicePlaybackSpeed * 100)
-			<< qint32(_closeToTaskbar.current() ? 1 : 0);
+			<< qint32(_closeToTaskbar.current() ? 1 : 0)
+			<< qint32(_sharedMediaCache ? 1 : 0)
+			<< qint32(_loadedHistoryViewsLimit);
 	}
 	return result;
 }
@@ -305,6 +307,8 @@ void Settings::addFromSerialized(const QByteArray &serialized) {
 	qint32 hiddenGroupCallTooltips = qint32(_hiddenGroupCallTooltips.value());
 	QByteArray photoEditorBrush = _photoEditorBrush;
 	qint32 closeToTaskbar = _closeToTaskbar.current() ? 1 : 0;
+	qint32 sharedMediaCache = _sharedMediaCache ? 1 : 0;
+	qint32 loadedHistoryViewsLimit = _loadedHistoryViewsLimit;
 
 	stream >> themesAccentColors;
 	if (!stream.atEnd()) {
@@ -465,6 +469,12 @@ void Settings::addFromSerialized(const QByteArray &serialized) {
 	if (!stream.atEnd()) {
 		stream >> closeToTaskbar;
 	}
+	if (!stream.atEnd()) {
+		stream >> sharedMediaCache;
+	}
+	if (!stream.atEnd()) {
+		stream >> loadedHistoryViewsLimit;
+	}
 	if (stream.status() != QDataStream::Ok) {
 		LOG(("App Error: "
 			"Bad data for Core::Settings::constructFromSerialized()"));
@@ -606,6 +616,8 @@ void Settings::addFromSerialized(const QByteArray &serialized) {
 	}();
 	_photoEditorBrush = photoEditorBrush;
 	_closeToTaskbar = (closeToTaskbar == 1);
+	_sharedMediaCache = (sharedMediaCache == 1);
+	_loadedHistoryViewsLimit = std::max(loadedHistoryViewsLimit, 0);
 }
 
 QString Settings::getSoundPath(const QString &key) const {
@@ -614,6 +614,22 @@ public:
 		return _closeToTaskbar.changes();
 	}
 
+	// Applied to sessions created after the change.
+	void setSharedMediaCache(bool value) {
+		_sharedMediaCache = value;
+	}
+	[[nodiscard]] bool sharedMediaCache() const {
+		return _sharedMediaCache;
+	}
+
+	// Budget of message views kept in histories that are not shown.
+	void setLoadedHistoryViewsLimit(int value) {
+		_loadedHistoryViewsLimit = std::max(value, 0);
+	}
+	[[nodiscard]] int loadedHistoryViewsLimit() const {
+		return _loadedHistoryViewsLimit;
+	}
+
 	[[nodiscard]] static bool ThirdColumnByDefault();
 	[[nodiscard]] static float64 DefaultDialogsWidthRatio();
 	[[nodiscard]] static qint32 SerializePlaybackSpeed(float64 speed) {
@@ -636,6 +652,7 @@ private:
 	static constexpr auto kDefaultThirdColumnWidth = 0;
 	static constexpr auto kDefaultDialogsWidthRatio = 5. / 14;
 	static constexpr auto kDefaultBigDialogsWidthRatio = 0.275;
+	static constexpr auto kDefaultLoadedHistoryViewsLimit = 20000;
 
 	struct RecentEmojiId {
 		QString emoji;
@@ -714,6 +731,8 @@ private:
 	rpl::variable<WorkMode> _workMode = WorkMode::WindowAndTray;
 	base::flags<Calls::Group::StickedTooltip> _hiddenGroupCallTooltips;
 	rpl::variable<bool> _closeToTaskbar = false;
+	bool _sharedMediaCache = false;
+	int _loadedHistoryViewsLimit = kDefaultLoadedHistoryViewsLimit;
 
 	bool _tabbedReplacedWithInfo = false; // per-window
 	rpl::event_stream<bool> _tabbedReplacedWithInfoValue; // per-window
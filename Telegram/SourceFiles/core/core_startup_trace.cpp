@@ -0,0 +1,119 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/core_startup_trace.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+namespace Core::StartupTrace {
+namespace {
+
+struct Event {
+	const char *name = nullptr;
+	crl::profile_time start = 0;
+	crl::profile_time duration = 0;
+};
+
+bool Enabled = false;
+crl::profile_time StartTime = 0;
+std::vector<Event> Events;
+
+const char *StepName = nullptr;
+crl::profile_time StepStarted = 0;
+
+void Add(const char *name, crl::profile_time started) {
+	Events.push_back({
+		.name = name,
+		.start = started,
+		.duration = crl::profile() - started,
+	});
+}
+
+void FinishStep() {
+	if (const auto name = base::take(StepName)) {
+		Add(name, StepStarted);
+	}
+}
+
+[[nodiscard]] QByteArray Serialize() {
+	auto events = QJsonArray();
+	for (const auto &event : Events) {
+		events.push_back(QJsonObject{
+			{ "name", QString::fromLatin1(event.name) },
+			{ "cat", "startup" },
+			{ "ph", "X" },
+			{ "ts", double(event.start - StartTime) },
+			{ "dur", double(event.duration) },
+			{ "pid", 1 },
+			{ "tid", 1 },
+		});
+	}
+	return QJsonDocument(QJsonObject{
+		{ "traceEvents", events },
+		{ "displayTimeUnit", "ms" },
+	}).toJson(QJsonDocument::Compact);
+}
+
+} // namespace
+
+void Start() {
+	if (!cTraceStartup() || Enabled) {
+		return;
+	}
+	Enabled = true;
+	StartTime = crl::profile();
+	Events.reserve(64);
+}
+
+bool Started() {
+	return Enabled;
+}
+
+void Step(const char *name) {
+	if (!Enabled) {
+		return;
+	}
+	FinishStep();
+	StepName = name;
+	StepStarted = crl::profile();
+}
+
+Scope::Scope(const char *name)
+: _name(name)
+, _started(Enabled ? crl::profile() : 0) {
+}
+
+Scope::~Scope() {
+	if (Enabled && _started) {
+		Add(_name, _started);
+	}
+}
+
+void Finish() {
+	if (!Enabled) {
+		return;
+	}
+	FinishStep();
+	Add("total", StartTime);
+	Enabled = false;
+
+	const auto path = cWorkingDir() + qsl("tdata/startup_trace.json");
+	auto f = QFile(path);
+	if (f.open(QIODevice::WriteOnly)) {
+		f.write(Serialize());
+		LOG(("Startup Trace: %1 events written to %2."
+			).arg(Events.size()
+			).arg(path));
+	} else {
+		LOG(("Startup Trace Error: could not write %1.").arg(path));
+	}
+	base::take(Events);
+}
+
+} // namespace Core::StartupTrace
@@ -0,0 +1,34 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core::StartupTrace {
+
+// Main thread only. Enabled by the "-tracestartup" launch option,
+// the result is written as Chrome trace JSON to tdata/startup_trace.json.
+
+void Start();
+[[nodiscard]] bool Started();
+
+// Finishes the previous step (if any) and starts a new one.
+void Step(const char *name);
+
+class Scope final {
+public:
+	explicit Scope(const char *name);
+	~Scope();
+
+private:
+	const char *_name = nullptr;
+	crl::profile_time _started = 0;
+
+};
+
+void Finish();
+
+} // namespace Core::StartupTrace
@@ -467,6 +467,8 @@ void Launcher::processArguments() {
 		{ "-cleanup"        , KeyFormat::NoValues },
 		{ "-noupdate"       , KeyFormat::NoValues },
 		{ "-tosettings"     , KeyFormat::NoValues },
+		{ "-tracestartup"   , KeyFormat::NoValues },
+		{ "-deferinit"      , KeyFormat::NoValues },
 		{ "-startintray"    , KeyFormat::NoValues },
 		{ "-quit"           , KeyFormat::NoValues },
 		{ "-sendpath"       , KeyFormat::AllLeftValues },
@@ -508,6 +510,8 @@ void Launcher::processArguments() {
 		: LaunchModeNormal;
 	gNoStartUpdate = parseResult.contains("-noupdate");
 	gStartToSettings = parseResult.contains("-tosettings");
+	gTraceStartup = parseResult.contains("-tracestartup");
+	gDeferredInit = parseResult.contains("-deferinit");
 	gStartInTray = parseResult.contains("-startintray");
 	gQuit = parseResult.contains("-quit");
 	gSendPaths = parseResult.value("-sendpath", {});
@@ -10,6 +10,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 
 namespace Data {
+namespace {
+
+constexpr auto kClearObjectStreamsMinCount = 1024;
+
+} // namespace
 
 template <typename DataType, typename UpdateType>
 void Changes::Manager<DataType, UpdateType>::updated(
@@ -23,7 +28,7 @@ void Changes::Manager<DataType, UpdateType>::updated(
 			flags |= i->second;
 			_updates.erase(i);
 		}
-		_stream.fire({ data, flags });
+		fire({ data, flags });
 	} else {
 		_updates[data] |= flags;
 	}
@@ -41,6 +46,40 @@ void Changes::Manager<DataType, UpdateType>::sendRealtimeNotifications(
 	}
 }
 
+template <typename DataType, typename UpdateType>
+void Changes::Manager<DataType, UpdateType>::fire(UpdateType &&update) {
+	const auto &[data, flags] = update;
+	const auto i = _objectStreams.find(data);
+	if (i != end(_objectStreams)) {
+		i->second.fire_copy(update);
+	}
+	_stream.fire(std::move(update));
+}
+
+template <typename DataType, typename UpdateType>
+auto Changes::Manager<DataType, UpdateType>::objectStream(
+	not_null<DataType*> data) const
+-> rpl::event_stream<UpdateType> & {
+	return _objectStreams[data];
+}
+
+template <typename DataType, typename UpdateType>
+void Changes::Manager<DataType, UpdateType>::clearUnusedObjectStreams() {
+	if (int(_objectStreams.size()) < _clearObjectStreamsAfter) {
+		return;
+	}
+	for (auto i = begin(_objectStreams); i != end(_objectStreams);) {
+		if (i->second.has_consumers()) {
+			++i;
+		} else {
+			i = _objectStreams.erase(i);
+		}
+	}
+	_clearObjectStreamsAfter = std::max(
+		kClearObjectStreamsMinCount,
+		int(_objectStreams.size()) * 2);
+}
+
 template <typename DataType, typename UpdateType>
 rpl::producer<UpdateType> Changes::Manager<DataType, UpdateType>::updates(
 		Flags flags) const {
@@ -54,10 +93,11 @@ template <typename DataType, typename UpdateType>
 rpl::producer<UpdateType> Changes::Manager<DataType, UpdateType>::updates(
 		not_null<DataType*> data,
 		Flags flags) const {
-	return _stream.events(
-	) | rpl::filter([=](const UpdateType &update) {
-		const auto [updateData, updateFlags] = update;
-		return (updateData == data) && (updateFlags & flags);
+	return rpl::deferred([=] {
+		return objectStream(data).events();
+	}) | rpl::filter([=](const UpdateType &update) {
+		const auto &[updateData, updateFlags] = update;
+		return (updateFlags & flags);
 	});
 }
 
@@ -79,8 +119,9 @@ rpl::producer<UpdateType> Changes::Manager<DataType, UpdateType>::flagsValue(
 template <typename DataType, typename UpdateType>
 void Changes::Manager<DataType, UpdateType>::sendNotifications() {
 	for (const auto &[data, flags] : base::take(_updates)) {
-		_stream.fire({ data, flags });
+		fire({ data, flags });
 	}
+	clearUnusedObjectStreams();
 }
 
 Changes::Changes(not_null<Main::Session*> session) : _session(session) {
@@ -272,11 +272,22 @@ private:
 		static constexpr auto kCount = details::CountBit<Flag>();
 
 		void sendRealtimeNotifications(not_null<DataType*> data, Flags flags);
+		void fire(UpdateType &&update);
+		[[nodiscard]] rpl::event_stream<UpdateType> &objectStream(
+			not_null<DataType*> data) const;
+		void clearUnusedObjectStreams();
 
 		std::array<rpl::event_stream<UpdateType>, kCount> _realtimeStreams;
 		base::flat_map<not_null<DataType*>, Flags> _updates;
 		rpl::event_stream<UpdateType> _stream;
 
+		// Subscribers to a single object get updates only for it.
+		// Nodes must be stable, a stream may be firing while we insert.
+		mutable std::map<
+			not_null<DataType*>,
+			rpl::event_stream<UpdateType>> _objectStreams;
+		int _clearObjectStreamsAfter = 0;
+
 	};
 
 	void scheduleNotifications();
@@ -24,12 +24,23 @@ namespace Data {
 namespace {
 
 constexpr auto kReadRequestTimeout = 3 * crl::time(1000);
+constexpr auto kUnloadInactiveTimeout = 10 * 60 * crl::time(1000);
+constexpr auto kUnloadInactiveCheckInterval = 60 * crl::time(1000);
+
+[[nodiscard]] int CountLoadedViews(not_null<History*> history) {
+	auto result = 0;
+	for (const auto &block : history->blocks) {
+		result += int(block->messages.size());
+	}
+	return result;
+}
 
 } // namespace
 
 Histories::Histories(not_null<Session*> owner)
 : _owner(owner)
-, _readRequestsTimer([=] { sendReadRequests(); }) {
+, _readRequestsTimer([=] { sendReadRequests(); })
+, _unloadInactiveTimer([=] { unloadInactive(); }) {
 }
 
 Session &Histories::owner() const {
@@ -61,12 +72,115 @@ void Histories::unloadAll() {
 	for (const auto &[peerId, history] : _map) {
 		history->clear(History::ClearType::Unload);
 	}
+	_hiddenAt.clear();
 }
 
 void Histories::clearAll() {
+	_shown.clear();
+	_hiddenAt.clear();
 	_map.clear();
 }
 
+rpl::lifetime Histories::historyShown(not_null<History*> history) {
+	// Remember what was counted, migrateFrom() may change meanwhile.
+	auto shown = std::vector<not_null<History*>>{ history };
+	if (const auto from = history->migrateFrom()) {
+		shown.push_back(from);
+	}
+	for (const auto &one : shown) {
+		++_shown[one];
+		_hiddenAt.remove(one);
+	}
+	return rpl::lifetime([=] {
+		historyHidden(shown);
+	});
+}
+
+void Histories::historyHidden(
+		const std::vector<not_null<History*>> &histories) {
+	const auto now = crl::now();
+	for (const auto &history : histories) {
+		// After clearAll() the histories may be destroyed already.
+		const auto i = _shown.find(history);
+		if (i == end(_shown) || --i->second > 0) {
+			continue;
+		}
+		_shown.erase(i);
+		_hiddenAt[history] = now;
+	}
+	if (!_hiddenAt.empty() && !_unloadInactiveTimer.isActive()) {
+		_unloadInactiveTimer.callEach(kUnloadInactiveCheckInterval);
+	}
+}
+
+int Histories::loadedViewsCount() const {
+	auto result = 0;
+	for (const auto &[history, count] : _shown) {
+		result += CountLoadedViews(history);
+	}
+	for (const auto &[history, when] : _hiddenAt) {
+		result += CountLoadedViews(history);
+	}
+	return result;
+}
+
+bool Histories::shownNow(not_null<History*> history) const {
+	if (_shown.contains(history)) {
+		return true;
+	} else if (const auto to = history->peer->migrateTo()) {
+		const auto i = _map.find(to->id);
+		return (i != end(_map)) && _shown.contains(i->second.get());
+	}
+	return false;
+}
+
+void Histories::unloadInactive() {
+	const auto now = crl::now();
+	const auto limit = Core::App().settings().loadedHistoryViewsLimit();
+	auto loaded = loadedViewsCount();
+	auto unloadedHistories = 0;
+	auto unloadedViews = 0;
+	const auto unload = [&](not_null<History*> history) {
+		const auto count = CountLoadedViews(history);
+		history->clear(History::ClearType::Unload);
+		loaded -= count;
+		unloadedViews += count;
+		++unloadedHistories;
+	};
+
+	// Oldest first, so that the budget drops the least recently shown.
+	auto hidden = std::vector<std::pair<crl::time, not_null<History*>>>();
+	hidden.reserve(_hiddenAt.size());
+	for (const auto &[history, when] : _hiddenAt) {
+		hidden.emplace_back(when, history);
+	}
+	ranges::sort(hidden, ranges::less(), [](const auto &pair) {
+		return pair.first;
+	});
+
+	for (const auto &[when, history] : hidden) {
+		if (shownNow(history)) {
+			continue;
+		} else if (now - when < kUnloadInactiveTimeout && loaded <= limit) {
+			break;
+		}
+		if (!history->blocks.empty()) {
+			unload(history);
+		}
+		_hiddenAt.remove(history);
+	}
+	if (unloadedHistories > 0) {
+		DEBUG_LOG(("Histories: unloaded %1 views in %2 histories, "
+			"%3 views still loaded."
+			).arg(unloadedViews
+			).arg(unloadedHistories
+			).arg(loaded));
+	}
+	if (_hiddenAt.empty()) {
+		_unloadInactiveTimer.cancel();
+	}
+}
+
 void Histories::readInbox(not_null<History*> history) {
 	DEBUG_LOG(("Reading: readInbox called."));
 	if (history->lastServerMessageKnown()) {
@@ -349,7 +463,7 @@ void Histories::sendDialogRequests() {
 		finalize();
 	}).fail([=](const MTP::Error &error) {
 		finalize();
-	}).send();
+	}).priority(MTP::RequestPriority::Background).send();
 }
 
 void Histories::dialogEntryApplied(not_null<History*> history) {
@@ -556,7 +670,7 @@ void Histories::sendReadRequest(not_null<History*> history, State &state) {
 				finished();
 			}).fail([=](const MTP::Error &error) {
 				finished();
-			}).send();
+			}).priority(MTP::RequestPriority::Background).send();
 		} else {
 			return session().api().request(MTPmessages_ReadHistory(
 				history->peer->input,
@@ -566,7 +680,7 @@ void Histories::sendReadRequest(not_null<History*> history, State &state) {
 				finished();
 			}).fail([=](const MTP::Error &error) {
 				finished();
-			}).send();
+			}).priority(MTP::RequestPriority::Background).send();
 		}
 	});
 }
@@ -44,6 +44,13 @@ public:
 	void unloadAll();
 	void clearAll();
 
+	// Histories with loaded blocks that are not shown are unloaded
+	// after a while, or earlier if over the loaded views budget.
+	// The history (and the one it was migrated from) counts as shown
+	// until the returned lifetime is destroyed.
+	[[nodiscard]] rpl::lifetime historyShown(not_null<History*> history);
+	[[nodiscard]] int loadedViewsCount() const;
+
 	void readInbox(not_null<History*> history);
 	void readInboxTill(not_null<HistoryItem*> item);
 	void readInboxTill(not_null<History*> history, MsgId tillId);
@@ -118,6 +125,10 @@ private:
 
 	void sendDialogRequests();
 
+	void historyHidden(const std::vector<not_null<History*>> &histories);
+	[[nodiscard]] bool shownNow(not_null<History*> history) const;
+	void unloadInactive();
+
 	const not_null<Session*> _owner;
 
 	std::unordered_map<PeerId, std::unique_ptr<History>> _map;
@@ -136,6 +147,10 @@ private:
 
 	base::flat_set<not_null<History*>> _fakeChatListRequests;
 
+	base::flat_map<not_null<History*>, int> _shown;
+	base::flat_map<not_null<History*>, crl::time> _hiddenAt;
+	base::Timer _unloadInactiveTimer;
+
 	base::flat_map<
 		not_null<History*>,
 		ChatListGroupRequest> _chatListGroupRequests;
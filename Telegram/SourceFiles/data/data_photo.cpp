@@ -169,6 +169,15 @@ void PhotoData::cancel() {
 	}
 }
 
+void PhotoData::stopLoading() {
+	const auto index = PhotoSizeIndex(PhotoSize::Large);
+	if (const auto loader = _images[index].loader.get()) {
+		// Unlike cancel() this keeps automatic loading allowed.
+		loader->cancel();
+		_images[index].flags &= ~Data::CloudFile::Flag::Cancelled;
+	}
+}
+
 float64 PhotoData::progress() const {
 	if (uploading()) {
 		if (uploadingData->size > 0) {
@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "history/history_item.h"
 #include "apiwrap.h"
+#include "api/api_search_cache.h"
 
 namespace Api {
 namespace {
@@ -372,6 +373,29 @@ void SearchController::requestMore(
 	if (!prepared) {
 		return;
 	}
+	const auto cacheKey = SearchResultsCache::Key{
+		.peerId = listData->peer->id,
+		.type = query.type,
+		.query = query.query,
+		.aroundId = key.aroundId,
+		.direction = key.direction,
+	};
+	if (auto cached = _session->api().searchCache().lookup(cacheKey)) {
+		// Deliver asynchronously, like a network response would be.
+		const auto alive = std::make_shared<bool>(true);
+		listData->requests.emplace(key, [=] { *alive = false; });
+		crl::on_main(_session, [=, result = std::move(*cached)]() mutable {
+			if (!*alive) {
+				return;
+			}
+			listData->requests.remove(key);
+			listData->list.addSlice(
+				std::move(result.messageIds),
+				result.noSkipRange,
+				result.fullCount);
+		});
+		return;
+	}
 	auto &histories = _session->data().histories();
 	const auto type = ::Data::Histories::RequestType::History;
 	const auto history = _session->data().history(listData->peer);
@@ -386,6 +410,7 @@ void SearchController::requestMore(
 				key.aroundId,
 				key.direction,
 				result);
+			_session->api().searchCache().store(cacheKey, parsed);
 			listData->list.addSlice(
 				std::move(parsed.messageIds),
 				parsed.noSkipRange,
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 #include "main/main_session_settings.h"
 #include "main/main_account.h"
+#include "main/main_domain.h"
 #include "apiwrap.h"
 #include "mainwidget.h"
 #include "api/api_text_entities.h"
@@ -216,12 +217,18 @@ std::vector<UnavailableReason> ExtractUnavailableReasons(
 
 Session::Session(not_null<Main::Session*> session)
 : _session(session)
+, _bigFileCacheShared(Core::App().settings().sharedMediaCache())
+, _bigFileCacheTag(_bigFileCacheShared
+	? uint8(_session->account().index() + 1)
+	: uint8(0))
 , _cache(Core::App().databases().get(
 	_session->local().cachePath(),
 	_session->local().cacheSettings()))
-, _bigFileCache(Core::App().databases().get(
-	_session->local().cacheBigFilePath(),
-	_session->local().cacheBigFileSettings()))
+, _bigFileCache(_bigFileCacheShared
+	? _session->domain().sharedCacheBigFile(&_session->account())
+	: Core::App().databases().get(
+		_session->local().cacheBigFilePath(),
+		_session->local().cacheBigFileSettings()))
 , _chatsList(
 	session,
 	FilterId(),
@@ -243,12 +250,17 @@ Session::Session(not_null<Main::Session*> session)
 , _stickers(std::make_unique<Stickers>(this))
 , _sponsoredMessages(std::make_unique<SponsoredMessages>(this)) {
 	_cache->open(_session->local().cacheKey());
-	_bigFileCache->open(_session->local().cacheBigFileKey());
+	if (!_bigFileCacheShared) {
+		// The shared one is opened by Main::Domain.
+		_bigFileCache->open(_session->local().cacheBigFileKey());
+	}
 
 	if constexpr (Platform::IsLinux()) {
 		const auto wasVersion = _session->local().oldMapVersion();
 		if (wasVersion >= 1007011 && wasVersion < 1007015) {
-			_bigFileCache->clear();
+			if (!_bigFileCacheShared) {
+				_bigFileCache->clear();
+			}
 			_cache->clearByTag(Data::kImageCacheTag);
 		}
 	}
@@ -1042,6 +1054,20 @@ Storage::Cache::Database &Session::cacheBigFile() {
 	return *_bigFileCache;
 }
 
+uint8 Session::cacheBigFileTag() const {
+	return _bigFileCacheTag;
+}
+
+void Session::updateCacheBigFileSettings(
+		const Storage::Cache::Database::SettingsUpdate &update) {
+	if (_bigFileCacheShared) {
+		_session->domain().updateSharedCacheBigFileSettings(
+			&_session->account());
+	} else {
+		_bigFileCache->updateSettings(update);
+	}
+}
+
 void Session::suggestStartExport(TimeId availableAt) {
 	_exportAvailableAt = availableAt;
 	suggestStartExport();
@@ -4120,8 +4146,13 @@ uint64 Session::wallpapersHash() const {
 void Session::clearLocalStorage() {
 	_cache->close();
 	_cache->clear();
-	_bigFileCache->close();
-	_bigFileCache->clear();
+	if (_bigFileCacheShared) {
+		// The shared one is removed by Main::Domain after the last logout.
+		_bigFileCache->clearByTag(_bigFileCacheTag);
+	} else {
+		_bigFileCache->close();
+		_bigFileCache->clear();
+	}
 }
 
 } // namespace Data
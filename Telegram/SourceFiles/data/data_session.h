@@ -135,6 +135,12 @@ public:
 	[[nodiscard]] Storage::Cache::Database &cache();
 	[[nodiscard]] Storage::Cache::Database &cacheBigFile();
 
+	// Entries this session puts to a shared media cache are tagged,
+	// so that they can be counted and cleared for this account only.
+	[[nodiscard]] uint8 cacheBigFileTag() const;
+	void updateCacheBigFileSettings(
+		const Storage::Cache::Database::SettingsUpdate &update);
+
 	[[nodiscard]] not_null<PeerData*> peer(PeerId id);
 	[[nodiscard]] not_null<PeerData*> peer(UserId id) = delete;
 	[[nodiscard]] not_null<UserData*> user(UserId id);
@@ -811,6 +817,8 @@ private:
 
 	const not_null<Main::Session*> _session;
 
+	const bool _bigFileCacheShared = false;
+	const uint8 _bigFileCacheTag = 0;
 	Storage::DatabasePointer _cache;
 	Storage::DatabasePointer _bigFileCache;
 
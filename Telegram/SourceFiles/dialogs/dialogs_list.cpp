@@ -13,6 +13,30 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 
 namespace Dialogs {
+namespace {
+
+// Like std::partition_point, but probes the range with growing steps
+// starting from `first`, so a row that moves by a few positions costs
+// only a few comparisons and a long jump costs O(log(distance)).
+template <typename Iterator, typename Predicate>
+[[nodiscard]] Iterator GallopPartitionPoint(
+		Iterator first,
+		Iterator last,
+		Predicate &&predicate) {
+	const auto size = (last - first);
+	auto from = decltype(size)(0);
+	auto till = decltype(size)(1);
+	while (till <= size && predicate(*(first + till - 1))) {
+		from = till;
+		till *= 2;
+	}
+	return std::partition_point(
+		first + from,
+		first + std::min(till, size),
+		std::forward<Predicate>(predicate));
+}
+
+} // namespace
 
 List::List(SortMode sortMode, FilterId filterId)
 : _sortMode(sortMode)
@@ -65,15 +89,17 @@ void List::adjustByName(not_null<Row*> row) {
 	const auto &key = row->entry()->chatListNameSortKey();
 	const auto index = row->pos();
 	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
-		return row->entry()->chatListNameSortKey().compare(key) >= 0;
+	const auto before = GallopPartitionPoint(i + 1, _rows.end(), [&](
+			Row *row) {
+		return row->entry()->chatListNameSortKey().compare(key) < 0;
 	});
 	if (before != i + 1) {
 		rotate(i, i + 1, before);
 	} else if (i != _rows.begin()) {
 		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
-			return row->entry()->chatListNameSortKey().compare(key) <= 0;
+		const auto after = GallopPartitionPoint(from, _rows.rend(), [&](
+				Row *row) {
+			return row->entry()->chatListNameSortKey().compare(key) > 0;
 		}).base();
 		if (after != i) {
 			rotate(after, i, i + 1);
@@ -87,15 +113,17 @@ void List::adjustByDate(not_null<Row*> row) {
 	const auto key = row->sortKey(_filterId);
 	const auto index = row->pos();
 	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
-		return (row->sortKey(_filterId) <= key);
+	const auto before = GallopPartitionPoint(i + 1, _rows.end(), [&](
+			Row *row) {
+		return (row->sortKey(_filterId) > key);
 	});
 	if (before != i + 1) {
 		rotate(i, i + 1, before);
 	} else {
 		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
-			return (row->sortKey(_filterId) >= key);
+		const auto after = GallopPartitionPoint(from, _rows.rend(), [&](
+				Row *row) {
+			return (row->sortKey(_filterId) < key);
 		}).base();
 		if (after != i) {
 			rotate(after, i, i + 1);
@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/mime_type.h"
 #include "core/utils.h"
 #include <QtCore/QDateTime>
+#include <QtCore/QMutex>
 #include <QtCore/QRegularExpression>
 #include <QtGui/QImageReader>
 #include <range/v3/algorithm/max_element.hpp>
@@ -616,6 +617,11 @@ std::pair<QString, QSize> WriteImageThumb(
 	const auto thumb = (firstDot >= 0)
 		? largePath.mid(0, firstDot) + postfix + largePath.mid(firstDot)
 		: largePath + postfix;
+
+	// Messages may be rendered in parallel, so choose a free name and
+	// write the thumb under a lock, two thumbs can't get the same path.
+	static QMutex mutex;
+	QMutexLocker lock(&mutex);
 	const auto result = Output::File::PrepareRelativePath(basePath, thumb);
 	if (!image.save(
 			basePath + result,
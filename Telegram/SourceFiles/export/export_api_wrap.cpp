@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "export/export_api_wrap.h"
 
+#include "export/export_manifest.h"
 #include "export/export_settings.h"
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_result.h"
@@ -65,6 +66,16 @@ LocationKey ComputeLocationKey(const Data::FileLocation &value) {
 	return result;
 }
 
+QString ComputeManifestKey(const Data::FileLocation &value) {
+	if (!value) {
+		return QString();
+	}
+	const auto key = ComputeLocationKey(value);
+	return key.id
+		? (QString::number(key.type, 16) + '_' + QString::number(key.id))
+		: QString();
+}
+
 Settings::Type SettingsFromDialogsType(Data::DialogInfo::Type type) {
 	using DialogType = Data::DialogInfo::Type;
 	switch (type) {
@@ -404,12 +415,14 @@ rpl::producer<Output::Result> ApiWrap::ioErrors() const {
 void ApiWrap::startExport(
 		const Settings &settings,
 		Output::Stats *stats,
+		Manifest *manifest,
 		FnMut<void(StartInfo)> done) {
 	Expects(_settings == nullptr);
 	Expects(_startProcess == nullptr);
 
 	_settings = std::make_unique<Settings>(settings);
 	_stats = stats;
+	_manifest = manifest;
 	_startProcess = std::make_unique<StartProcess>();
 	_startProcess->done = std::move(done);
 
@@ -1024,11 +1037,44 @@ void ApiWrap::messagesCountLoaded(int localSplitIndex, int count) {
 	_chatProcess->info.messagesCountPerSplit[localSplitIndex] = count;
 	if (localSplitIndex + 1 < _chatProcess->info.splits.size()) {
 		requestMessagesCount(localSplitIndex + 1);
-	} else if (_chatProcess->start(_chatProcess->info)) {
+		return;
+	}
+	skipExportedMessages();
+	if (_chatProcess->start(_chatProcess->info)) {
 		requestMessagesSlice();
 	}
 }
 
+void ApiWrap::skipExportedMessages() {
+	Expects(_chatProcess != nullptr);
+
+	const auto state = _manifest
+		? _manifest->dialog(_chatProcess->info.peerId)
+		: nullptr;
+	if (!state) {
+		return;
+	}
+	auto &info = _chatProcess->info;
+	const auto i = ranges::find(info.splits, state->split);
+	if (i == end(info.splits)) {
+		// Splits changed since the previous run, export everything.
+		return;
+	}
+	const auto localSplitIndex = int(i - begin(info.splits));
+	auto &counts = info.messagesCountPerSplit;
+	for (auto j = 0; j != localSplitIndex; ++j) {
+		counts[j] = 0;
+	}
+	if (auto &count = counts[localSplitIndex]; count > 0) {
+		// The count includes messages before nextId, but it is only used
+		// for progress, so keep asking the split even if it looks done.
+		count = std::max(count - state->splitMessages, 1);
+	}
+	_chatProcess->localSplitIndex = localSplitIndex;
+	_chatProcess->largestIdPlusOne = state->nextId;
+	_stats->incrementSkippedMessages(state->messages);
+}
+
 void ApiWrap::finishExport(FnMut<void()> done) {
 	const auto guard = gsl::finally([&] { _takeoutId = std::nullopt; });
 
@@ -1550,6 +1596,13 @@ void ApiWrap::finishMessagesSlice() {
 		_chatProcess->largestIdPlusOne = slice.list.back().id + 1;
 		const auto splitIndex = _chatProcess->info.splits[
 			_chatProcess->localSplitIndex];
+		if (_manifest) {
+			_manifest->messagesExported(
+				_chatProcess->info.peerId,
+				splitIndex,
+				_chatProcess->largestIdPlusOne,
+				int(slice.list.size()));
+		}
 		if (splitIndex < 0) {
 			slice = AdjustMigrateMessageIds(std::move(slice));
 		}
@@ -1691,11 +1744,18 @@ bool ApiWrap::writePreloadedFile(
 	if (const auto path = _fileCache->find(file.location)) {
 		file.relativePath = *path;
 		return true;
+	} else if (const auto path = _manifest
+		? _manifest->findFile(ComputeManifestKey(file.location))
+		: std::nullopt) {
+		file.relativePath = *path;
+		_fileCache->save(file.location, file.relativePath);
+		_stats->incrementSkippedFiles();
+		return true;
 	} else if (!file.content.isEmpty()) {
 		const auto process = prepareFileProcess(file, origin);
 		if (const auto result = process->file.writeBlock(file.content)) {
 			file.relativePath = process->relativePath;
-			_fileCache->save(file.location, file.relativePath);
+			fileSaved(file.location, file.relativePath);
 		} else {
 			ioError(result);
 		}
@@ -1842,10 +1902,21 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 
 	auto process = base::take(_fileProcess);
 	const auto relativePath = process->relativePath;
-	_fileCache->save(process->location, relativePath);
+	fileSaved(process->location, relativePath);
 	process->done(process->relativePath);
 }
 
+void ApiWrap::fileSaved(
+		const Data::FileLocation &location,
+		const QString &relativePath) {
+	_fileCache->save(location, relativePath);
+	if (_manifest) {
+		if (const auto key = ComputeManifestKey(location); !key.isEmpty()) {
+			_manifest->fileExported(key, relativePath);
+		}
+	}
+}
+
 void ApiWrap::filePartRefreshReference(int offset) {
 	Expects(_fileProcess != nullptr);
 	Expects(_fileProcess->requestId == 0);
@@ -33,6 +33,7 @@ class Stats;
 } // namespace Output
 
 struct Settings;
+class Manifest;
 
 class ApiWrap {
 public:
@@ -48,6 +49,7 @@ public:
 	void startExport(
 		const Settings &settings,
 		Output::Stats *stats,
+		Manifest *manifest,
 		FnMut<void(StartInfo)> done);
 
 	void requestDialogsList(
@@ -149,6 +151,7 @@ private:
 	void requestMessagesCount(int localSplitIndex);
 	void checkFirstMessageDate(int localSplitIndex, int count);
 	void messagesCountLoaded(int localSplitIndex, int count);
+	void skipExportedMessages();
 	void requestMessagesSlice();
 	void requestChatMessages(
 		int splitIndex,
@@ -180,6 +183,9 @@ private:
 	bool writePreloadedFile(
 		Data::File &file,
 		const Data::FileOrigin &origin);
+	void fileSaved(
+		const Data::FileLocation &location,
+		const QString &relativePath);
 	void loadFile(
 		const Data::File &file,
 		const Data::FileOrigin &origin,
@@ -214,6 +220,7 @@ private:
 	std::optional<uint64> _takeoutId;
 	std::optional<UserId> _selfId;
 	Output::Stats *_stats = nullptr;
+	Manifest *_manifest = nullptr;
 
 	std::unique_ptr<Settings> _settings;
 	MTPInputUser _user = MTP_inputUserSelf();
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/export_controller.h"
 
 #include "export/export_api_wrap.h"
+#include "export/export_manifest.h"
 #include "export/export_settings.h"
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_abstract.h"
@@ -119,6 +120,7 @@ private:
 	rpl::event_stream<State> _stateChanges;
 
 	Output::Stats _stats;
+	Manifest _manifest;
 
 	std::vector<int> _substepsInStep;
 	int _substepsTotal = 0;
@@ -249,6 +251,9 @@ void ControllerObject::startExport(
 	_environment = environment;
 
 	_settings.path = Output::NormalizePath(_settings);
+	if (_settings.incremental) {
+		_manifest.start(settings.path, _settings.path);
+	}
 	_writer = Output::CreateWriter(_settings.format);
 	fillExportSteps();
 	exportNext();
@@ -331,6 +336,8 @@ void ControllerObject::exportNext() {
 	if (++_stepIndex >= _steps.size()) {
 		if (ioCatchError(_writer->finish())) {
 			return;
+		} else if (_manifest.started() && ioCatchError(_manifest.write())) {
+			return;
 		}
 		_api.finishExport([=] {
 			setFinishedState();
@@ -354,7 +361,9 @@ void ControllerObject::exportNext() {
 
 void ControllerObject::initialize() {
 	setState(stateInitializing());
-	_api.startExport(_settings, &_stats, [=](ApiWrap::StartInfo info) {
+	const auto manifest = _manifest.started() ? &_manifest : nullptr;
+	_api.startExport(_settings, &_stats, manifest, [=](
+			ApiWrap::StartInfo info) {
 		initialized(info);
 	});
 }
@@ -603,10 +612,17 @@ int ControllerObject::substepsInStep(Step step) const {
 }
 
 void ControllerObject::setFinishedState() {
+	if (_manifest.started()) {
+		LOG(("Export Info: Skipped %1 messages and %2 files exported before."
+			).arg(_stats.skippedMessagesCount()
+			).arg(_stats.skippedFilesCount()));
+	}
 	setState(FinishedState{
 		_writer->mainFilePath(),
 		_stats.filesCount(),
-		_stats.bytesCount() });
+		_stats.bytesCount(),
+		_stats.skippedMessagesCount(),
+		_stats.skippedFilesCount() });
 }
 
 Controller::Controller(
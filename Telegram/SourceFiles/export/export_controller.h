@@ -96,6 +96,8 @@ struct FinishedState {
 	QString path;
 	int filesCount = 0;
 	int64 bytesCount = 0;
+	int skippedMessagesCount = 0;
+	int skippedFilesCount = 0;
 };
 
 using State = std::variant<
@@ -0,0 +1,153 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "export/export_manifest.h"
+
+#include "export/output/export_output_result.h"
+
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonArray>
+#include <QtCore/QSaveFile>
+
+namespace Export {
+namespace {
+
+constexpr auto kVersion = 1;
+constexpr auto kFileName = "export_manifest.json";
+
+} // namespace
+
+void Manifest::start(const QString &folder, const QString &runPath) {
+	Expects(!folder.isEmpty());
+
+	_folder = folder.endsWith('/') ? folder : (folder + '/');
+	_run = QDir(_folder).relativeFilePath(runPath);
+	if (!_run.isEmpty() && !_run.endsWith('/')) {
+		_run += '/';
+	}
+
+	auto file = QFile(filePath());
+	if (!file.exists()) {
+		return;
+	} else if (!file.open(QIODevice::ReadOnly)) {
+		LOG(("Export Error: Could not read manifest '%1'.").arg(filePath()));
+		return;
+	}
+	auto error = QJsonParseError{ 0, QJsonParseError::NoError };
+	const auto document = QJsonDocument::fromJson(file.readAll(), &error);
+	if (error.error != QJsonParseError::NoError || !document.isObject()) {
+		LOG(("Export Error: Bad manifest '%1'.").arg(filePath()));
+		return;
+	}
+	const auto root = document.object();
+	if (root.value("version").toInt() != kVersion) {
+		LOG(("Export Error: Unknown manifest version in '%1'."
+			).arg(filePath()));
+		return;
+	}
+	for (const auto &value : root.value("dialogs").toArray()) {
+		const auto object = value.toObject();
+		const auto peerId = PeerId(
+			object.value("peer").toString().toULongLong());
+		if (!peerId) {
+			continue;
+		}
+		_dialogs.emplace(peerId, DialogState{
+			.split = object.value("split").toInt(),
+			.nextId = object.value("next_id").toInt(1),
+			.splitMessages = object.value("split_messages").toInt(),
+			.messages = object.value("messages").toInt(),
+		});
+	}
+	const auto files = root.value("files").toObject();
+	for (auto i = files.begin(); i != files.end(); ++i) {
+		_files.emplace(i.key(), i.value().toString());
+	}
+}
+
+bool Manifest::started() const {
+	return !_folder.isEmpty();
+}
+
+const Manifest::DialogState *Manifest::dialog(PeerId peerId) const {
+	const auto i = _dialogs.find(peerId);
+	return (i != end(_dialogs)) ? &i->second : nullptr;
+}
+
+void Manifest::messagesExported(
+		PeerId peerId,
+		int split,
+		int32 nextId,
+		int count) {
+	auto &state = _dialogs[peerId];
+	if (state.split != split) {
+		state.split = split;
+		state.splitMessages = 0;
+	}
+	state.nextId = nextId;
+	state.splitMessages += count;
+	state.messages += count;
+}
+
+std::optional<QString> Manifest::findFile(const QString &key) const {
+	const auto i = _files.find(key);
+	if (i == end(_files)) {
+		return std::nullopt;
+	} else if (!QFile::exists(_folder + i->second)) {
+		return std::nullopt;
+	}
+	return i->second.startsWith(_run)
+		? i->second.mid(_run.size())
+		: QDir(_folder + _run).relativeFilePath(_folder + i->second);
+}
+
+void Manifest::fileExported(
+		const QString &key,
+		const QString &relativePath) {
+	if (!relativePath.isEmpty()) {
+		_files[key] = _run + relativePath;
+	}
+}
+
+Output::Result Manifest::write() const {
+	Expects(started());
+
+	auto dialogs = QJsonArray();
+	for (const auto &[peerId, state] : _dialogs) {
+		dialogs.append(QJsonObject{
+			{ "peer", QString::number(peerId.value) },
+			{ "split", state.split },
+			{ "next_id", state.nextId },
+			{ "split_messages", state.splitMessages },
+			{ "messages", state.messages },
+		});
+	}
+	auto files = QJsonObject();
+	for (const auto &[key, path] : _files) {
+		files.insert(key, path);
+	}
+	const auto root = QJsonObject{
+		{ "version", kVersion },
+		{ "dialogs", dialogs },
+		{ "files", files },
+	};
+
+	auto file = QSaveFile(filePath());
+	if (!file.open(QIODevice::WriteOnly)
+		|| file.write(QJsonDocument(root).toJson()) < 0
+		|| !file.commit()) {
+		return Output::Result(Output::Result::Type::Error, filePath());
+	}
+	return Output::Result::Success();
+}
+
+QString Manifest::filePath() const {
+	return _folder + kFileName;
+}
+
+} // namespace Export
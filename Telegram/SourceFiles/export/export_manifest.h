@@ -0,0 +1,66 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "data/data_peer_id.h"
+
+namespace Export {
+namespace Output {
+struct Result;
+} // namespace Output
+
+// What previous incremental exports to the same folder already wrote.
+//
+// Every incremental run goes to its own subfolder of the chosen folder,
+// the manifest lives in the chosen folder itself and remembers for each
+// dialog where the last run stopped and for each downloaded file which
+// run has it, so the next run fetches only newer messages and unseen
+// files and links to the older copies instead.
+class Manifest final {
+public:
+	struct DialogState {
+		int split = 0; // Value from DialogInfo::splits.
+		int32 nextId = 1; // Message id to continue from in that split.
+		int splitMessages = 0; // Already exported from that split.
+		int messages = 0; // Already exported from the whole dialog.
+	};
+
+	Manifest() = default;
+	Manifest(const Manifest &other) = delete;
+	Manifest &operator=(const Manifest &other) = delete;
+
+	// Reads the manifest from the folder, a missing one is not an error.
+	// The run folder is the normalized export path of this run inside it.
+	void start(const QString &folder, const QString &runPath);
+	[[nodiscard]] bool started() const;
+
+	[[nodiscard]] const DialogState *dialog(PeerId peerId) const;
+	void messagesExported(
+		PeerId peerId,
+		int split,
+		int32 nextId,
+		int count);
+
+	// Returns a path relative to the run folder if some run has the file.
+	[[nodiscard]] std::optional<QString> findFile(
+		const QString &key) const;
+	void fileExported(const QString &key, const QString &relativePath);
+
+	[[nodiscard]] Output::Result write() const;
+
+private:
+	[[nodiscard]] QString filePath() const;
+
+	QString _folder;
+	QString _run;
+	base::flat_map<PeerId, DialogState> _dialogs;
+	base::flat_map<QString, QString> _files;
+
+};
+
+} // namespace Export
@@ -71,6 +71,7 @@ struct Settings {
 
 	QString path;
 	bool forceSubPath = false;
+	bool incremental = false;
 	Output::Format format = Output::Format();
 
 	Types types = DefaultTypes();
@@ -22,12 +22,13 @@ QString NormalizePath(const Settings &settings) {
 	QDir folder(settings.path);
 	const auto path = folder.absolutePath();
 	auto result = path.endsWith('/') ? path : (path + '/');
-	if (!folder.exists() && !settings.forceSubPath) {
+	const auto forceSubPath = settings.forceSubPath || settings.incremental;
+	if (!folder.exists() && !forceSubPath) {
 		return result;
 	}
 	const auto mode = QDir::AllEntries | QDir::NoDotAndDotDot;
 	const auto list = folder.entryInfoList(mode);
-	if (list.isEmpty() && !settings.forceSubPath) {
+	if (list.isEmpty() && !forceSubPath) {
 		return result;
 	}
 	const auto date = QDate::currentDate();
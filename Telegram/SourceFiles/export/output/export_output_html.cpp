@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QSize>
 #include <QtCore/QFile>
+#include <QtCore/QThread>
 #include <QtCore/QDateTime>
 
 namespace Export {
@@ -21,6 +22,7 @@ namespace Output {
 namespace {
 
 constexpr auto kMessagesInFile = 1000;
+constexpr auto kParallelRenderMinPart = 25;
 constexpr auto kPersonalUserpicSize = 90;
 constexpr auto kEntryUserpicSize = 48;
 constexpr auto kServiceMessagePhotoSize = 60;
@@ -470,6 +472,10 @@ class HtmlWriter::Wrap {
 public:
 	Wrap(const QString &path, const QString &base, Stats *stats);
 
+	// Render-only wrap with the same nesting, it can't write blocks.
+	Wrap(const QByteArray &base, const Context &context);
+	[[nodiscard]] std::unique_ptr<Wrap> renderer() const;
+
 	[[nodiscard]] bool empty() const;
 
 	[[nodiscard]] QByteArray pushTag(
@@ -522,6 +528,10 @@ public:
 		const QString &internalLinksDomain,
 		Fn<QByteArray(int messageId, QByteArray text)> wrapMessageLink);
 
+	[[nodiscard]] static MessageInfo PrepareMessageInfo(
+		const Data::Message &message,
+		const QByteArray &serviceText);
+
 	[[nodiscard]] Result writeBlock(const QByteArray &block);
 
 	[[nodiscard]] Result close();
@@ -631,6 +641,198 @@ QString WriteUserpicThumb(
 		postfix);
 }
 
+QByteArray ComposeServiceText(
+		const Data::Message &message,
+		const Data::DialogInfo &dialog,
+		const PeersMap &peers,
+		const Fn<QByteArray(int messageId, QByteArray text)> &wrapMessageLink) {
+	using namespace Data;
+
+	const auto wrapReplyToLink = [&](const QByteArray &text) {
+		return wrapMessageLink(message.replyToMsgId, text);
+	};
+
+	using DialogType = Data::DialogInfo::Type;
+	const auto isChannel = (dialog.type == DialogType::PrivateChannel)
+		|| (dialog.type == DialogType::PublicChannel);
+	const auto serviceFrom = peers.wrapPeerName(message.fromId);
+	return v::match(message.action.content, [&](
+			const ActionChatCreate &data) {
+		return serviceFrom
+			+ " created group &laquo;"
+			+ SerializeString(data.title)
+			+ "&raquo;"
+			+ (data.userIds.empty()
+				? QByteArray()
+				: " with members " + peers.wrapUserNames(data.userIds));
+	}, [&](const ActionChatEditTitle &data) {
+		return isChannel
+			? ("Channel title changed to &laquo;"
+				+ SerializeString(data.title)
+				+ "&raquo;")
+			: (serviceFrom
+				+ " changed group title to &laquo;"
+				+ SerializeString(data.title)
+				+ "&raquo;");
+	}, [&](const ActionChatEditPhoto &data) {
+		return isChannel
+			? QByteArray("Channel photo changed")
+			: (serviceFrom + " changed group photo");
+	}, [&](const ActionChatDeletePhoto &data) {
+		return isChannel
+			? QByteArray("Channel photo removed")
+			: (serviceFrom + " removed group photo");
+	}, [&](const ActionChatAddUser &data) {
+		return serviceFrom
+			+ " invited "
+			+ peers.wrapUserNames(data.userIds);
+	}, [&](const ActionChatDeleteUser &data) {
+		return serviceFrom
+			+ " removed "
+			+ peers.wrapUserName(data.userId);
+	}, [&](const ActionChatJoinedByLink &data) {
+		return serviceFrom
+			+ " joined group by link from "
+			+ peers.wrapUserName(data.inviterId);
+	}, [&](const ActionChannelCreate &data) {
+		return "Channel &laquo;"
+			+ SerializeString(data.title)
+			+ "&raquo; created";
+	}, [&](const ActionChatMigrateTo &data) {
+		return serviceFrom
+			+ " converted this group to a supergroup";
+	}, [&](const ActionChannelMigrateFrom &data) {
+		return serviceFrom
+			+ " converted a basic group to this supergroup "
+			+ "&laquo;" + SerializeString(data.title) + "&raquo;";
+	}, [&](const ActionPinMessage &data) {
+		return serviceFrom
+			+ " pinned "
+			+ wrapReplyToLink("this message");
+	}, [&](const ActionHistoryClear &data) {
+		return QByteArray("History cleared");
+	}, [&](const ActionGameScore &data) {
+		return serviceFrom
+			+ " scored "
+			+ NumberToString(data.score)
+			+ " in "
+			+ wrapReplyToLink("this game");
+	}, [&](const ActionPaymentSent &data) {
+		return "You have successfully transferred "
+			+ FormatMoneyAmount(data.amount, data.currency)
+			+ " for "
+			+ wrapReplyToLink("this invoice");
+	}, [&](const ActionPhoneCall &data) {
+		return QByteArray();
+	}, [&](const ActionScreenshotTaken &data) {
+		return serviceFrom + " took a screenshot";
+	}, [&](const ActionCustomAction &data) {
+		return data.message;
+	}, [&](const ActionBotAllowed &data) {
+		return "You allowed this bot to message you when you logged in on "
+			+ SerializeString(data.domain);
+	}, [&](const ActionSecureValuesSent &data) {
+		auto list = std::vector<QByteArray>();
+		for (const auto type : data.types) {
+			list.push_back([&] {
+				using Type = ActionSecureValuesSent::Type;
+				switch (type) {
+				case Type::PersonalDetails: return "Personal details";
+				case Type::Passport: return "Passport";
+				case Type::DriverLicense: return "Driver license";
+				case Type::IdentityCard: return "Identity card";
+				case Type::InternalPassport: return "Internal passport";
+				case Type::Address: return "Address information";
+				case Type::UtilityBill: return "Utility bill";
+				case Type::BankStatement: return "Bank statement";
+				case Type::RentalAgreement: return "Rental agreement";
+				case Type::PassportRegistration:
+					return "Passport registration";
+				case Type::TemporaryRegistration:
+					return "Temporary registration";
+				case Type::Phone: return "Phone number";
+				case Type::Email: return "Email";
+				}
+				return "";
+			}());
+		}
+		return "You have sent the following documents: "
+			+ SerializeList(list);
+	}, [&](const ActionContactSignUp &data) {
+		return serviceFrom + " joined Telegram";
+	}, [&](const ActionGeoProximityReached &data) {
+		const auto fromName = peers.wrapPeerName(data.fromId);
+		const auto toName = peers.wrapPeerName(data.toId);
+		const auto distance = [&]() -> QString {
+			if (data.distance >= 1000) {
+				const auto km = (10 * (data.distance / 10)) / 1000.;
+				return QString::number(km) + " km";
+			} else if (data.distance == 1) {
+				return "1 meter";
+			} else {
+				return QString::number(data.distance) + " meters";
+			}
+		}().toUtf8();
+		if (data.fromSelf) {
+			return "You are now within " + distance + " from " + toName;
+		} else if (data.toSelf) {
+			return fromName + " is now within " + distance + " from you";
+		} else {
+			return fromName
+				+ " is now within "
+				+ distance
+				+ " from "
+				+ toName;
+		}
+	}, [&](const ActionPhoneNumberRequest &data) {
+		return serviceFrom + " requested your phone number";
+	}, [&](const ActionGroupCall &data) {
+		const auto durationText = (data.duration
+			? (" (" + QString::number(data.duration) + " seconds)")
+			: QString()).toUtf8();
+		return isChannel
+			? ("Voice chat" + durationText)
+			: (serviceFrom + " started voice chat" + durationText);
+	}, [&](const ActionInviteToGroupCall &data) {
+		return serviceFrom
+			+ " invited "
+			+ peers.wrapUserNames(data.userIds)
+			+ " to the voice chat";
+	}, [&](const ActionSetMessagesTTL &data) {
+		const auto periodText = (data.period == 7 * 86400)
+			? "7 days"
+			: (data.period == 86400)
+			? "24 hours"
+			: QByteArray();
+		return isChannel
+			? (data.period
+				? "New messages will auto-delete in " + periodText
+				: "New messages will not auto-delete")
+			: (data.period
+				? (serviceFrom
+					+ " has set messages to auto-delete in " + periodText)
+				: (serviceFrom
+					+ " has set messages not to auto-delete"));
+	}, [&](const ActionGroupCallScheduled &data) {
+		const auto dateText = FormatDateTime(data.date);
+		return isChannel
+			? ("Voice chat scheduled for " + dateText)
+			: (serviceFrom + " scheduled a voice chat for " + dateText);
+	}, [&](const ActionSetChatTheme &data) {
+		if (data.emoji.isEmpty()) {
+			return isChannel
+				? "Channel theme was disabled"
+				: (serviceFrom + " disabled chat theme");
+		}
+		return isChannel
+			? ("Channel theme was changed to " + data.emoji).toUtf8()
+			: (serviceFrom + " changed chat theme to " + data.emoji).toUtf8();
+	}, [&](const ActionChatJoinedByRequest &data) {
+		return serviceFrom
+			+ " joined group by request";
+	}, [](v::null_t) { return QByteArray(); });
+}
+
 HtmlWriter::Wrap::Wrap(
 	const QString &path,
 	const QString &base,
@@ -646,6 +848,17 @@ HtmlWriter::Wrap::Wrap(
 	_composedStart = composeStart();
 }
 
+HtmlWriter::Wrap::Wrap(const QByteArray &base, const Context &context)
+: _file(QString(), nullptr)
+, _closed(true)
+, _base(base)
+, _context(context) {
+}
+
+auto HtmlWriter::Wrap::renderer() const -> std::unique_ptr<Wrap> {
+	return std::make_unique<Wrap>(_base, _context);
+}
+
 bool HtmlWriter::Wrap::empty() const {
 	return _file.empty();
 }
@@ -908,18 +1121,8 @@ auto HtmlWriter::Wrap::pushMessage(
 ) -> std::pair<MessageInfo, QByteArray> {
 	using namespace Data;
 
-	auto info = MessageInfo();
-	info.id = message.id;
-	info.fromId = message.fromId;
-	info.viaBotId = message.viaBotId;
-	info.date = message.date;
-	info.forwardedFromId = message.forwardedFromId;
-	info.forwardedFromName = message.forwardedFromName;
-	info.forwardedDate = message.forwardedDate;
-	info.forwarded = message.forwarded;
-	info.showForwardedAsOriginal = message.showForwardedAsOriginal;
 	if (v::is<UnsupportedMedia>(message.media.content)) {
-		return { info, pushServiceMessage(
+		return { PrepareMessageInfo(message, {}), pushServiceMessage(
 			message.id,
 			dialog,
 			basePath,
@@ -927,189 +1130,12 @@ auto HtmlWriter::Wrap::pushMessage(
 			"of Telegram Desktop. Please update the application.") };
 	}
 
-	const auto wrapReplyToLink = [&](const QByteArray &text) {
-		return wrapMessageLink(message.replyToMsgId, text);
-	};
-
-	using DialogType = Data::DialogInfo::Type;
-	const auto isChannel = (dialog.type == DialogType::PrivateChannel)
-		|| (dialog.type == DialogType::PublicChannel);
-	const auto serviceFrom = peers.wrapPeerName(message.fromId);
-	const auto serviceText = v::match(message.action.content, [&](
-			const ActionChatCreate &data) {
-		return serviceFrom
-			+ " created group &laquo;"
-			+ SerializeString(data.title)
-			+ "&raquo;"
-			+ (data.userIds.empty()
-				? QByteArray()
-				: " with members " + peers.wrapUserNames(data.userIds));
-	}, [&](const ActionChatEditTitle &data) {
-		return isChannel
-			? ("Channel title changed to &laquo;"
-				+ SerializeString(data.title)
-				+ "&raquo;")
-			: (serviceFrom
-				+ " changed group title to &laquo;"
-				+ SerializeString(data.title)
-				+ "&raquo;");
-	}, [&](const ActionChatEditPhoto &data) {
-		return isChannel
-			? QByteArray("Channel photo changed")
-			: (serviceFrom + " changed group photo");
-	}, [&](const ActionChatDeletePhoto &data) {
-		return isChannel
-			? QByteArray("Channel photo removed")
-			: (serviceFrom + " removed group photo");
-	}, [&](const ActionChatAddUser &data) {
-		return serviceFrom
-			+ " invited "
-			+ peers.wrapUserNames(data.userIds);
-	}, [&](const ActionChatDeleteUser &data) {
-		return serviceFrom
-			+ " removed "
-			+ peers.wrapUserName(data.userId);
-	}, [&](const ActionChatJoinedByLink &data) {
-		return serviceFrom
-			+ " joined group by link from "
-			+ peers.wrapUserName(data.inviterId);
-	}, [&](const ActionChannelCreate &data) {
-		return "Channel &laquo;"
-			+ SerializeString(data.title)
-			+ "&raquo; created";
-	}, [&](const ActionChatMigrateTo &data) {
-		return serviceFrom
-			+ " converted this group to a supergroup";
-	}, [&](const ActionChannelMigrateFrom &data) {
-		return serviceFrom
-			+ " converted a basic group to this supergroup "
-			+ "&laquo;" + SerializeString(data.title) + "&raquo;";
-	}, [&](const ActionPinMessage &data) {
-		return serviceFrom
-			+ " pinned "
-			+ wrapReplyToLink("this message");
-	}, [&](const ActionHistoryClear &data) {
-		return QByteArray("History cleared");
-	}, [&](const ActionGameScore &data) {
-		return serviceFrom
-			+ " scored "
-			+ NumberToString(data.score)
-			+ " in "
-			+ wrapReplyToLink("this game");
-	}, [&](const ActionPaymentSent &data) {
-		return "You have successfully transferred "
-			+ FormatMoneyAmount(data.amount, data.currency)
-			+ " for "
-			+ wrapReplyToLink("this invoice");
-	}, [&](const ActionPhoneCall &data) {
-		return QByteArray();
-	}, [&](const ActionScreenshotTaken &data) {
-		return serviceFrom + " took a screenshot";
-	}, [&](const ActionCustomAction &data) {
-		return data.message;
-	}, [&](const ActionBotAllowed &data) {
-		return "You allowed this bot to message you when you logged in on "
-			+ SerializeString(data.domain);
-	}, [&](const ActionSecureValuesSent &data) {
-		auto list = std::vector<QByteArray>();
-		for (const auto type : data.types) {
-			list.push_back([&] {
-				using Type = ActionSecureValuesSent::Type;
-				switch (type) {
-				case Type::PersonalDetails: return "Personal details";
-				case Type::Passport: return "Passport";
-				case Type::DriverLicense: return "Driver license";
-				case Type::IdentityCard: return "Identity card";
-				case Type::InternalPassport: return "Internal passport";
-				case Type::Address: return "Address information";
-				case Type::UtilityBill: return "Utility bill";
-				case Type::BankStatement: return "Bank statement";
-				case Type::RentalAgreement: return "Rental agreement";
-				case Type::PassportRegistration:
-					return "Passport registration";
-				case Type::TemporaryRegistration:
-					return "Temporary registration";
-				case Type::Phone: return "Phone number";
-				case Type::Email: return "Email";
-				}
-				return "";
-			}());
-		}
-		return "You have sent the following documents: "
-			+ SerializeList(list);
-	}, [&](const ActionContactSignUp &data) {
-		return serviceFrom + " joined Telegram";
-	}, [&](const ActionGeoProximityReached &data) {
-		const auto fromName = peers.wrapPeerName(data.fromId);
-		const auto toName = peers.wrapPeerName(data.toId);
-		const auto distance = [&]() -> QString {
-			if (data.distance >= 1000) {
-				const auto km = (10 * (data.distance / 10)) / 1000.;
-				return QString::number(km) + " km";
-			} else if (data.distance == 1) {
-				return "1 meter";
-			} else {
-				return QString::number(data.distance) + " meters";
-			}
-		}().toUtf8();
-		if (data.fromSelf) {
-			return "You are now within " + distance + " from " + toName;
-		} else if (data.toSelf) {
-			return fromName + " is now within " + distance + " from you";
-		} else {
-			return fromName
-				+ " is now within "
-				+ distance
-				+ " from "
-				+ toName;
-		}
-	}, [&](const ActionPhoneNumberRequest &data) {
-		return serviceFrom + " requested your phone number";
-	}, [&](const ActionGroupCall &data) {
-		const auto durationText = (data.duration
-			? (" (" + QString::number(data.duration) + " seconds)")
-			: QString()).toUtf8();
-		return isChannel
-			? ("Voice chat" + durationText)
-			: (serviceFrom + " started voice chat" + durationText);
-	}, [&](const ActionInviteToGroupCall &data) {
-		return serviceFrom
-			+ " invited "
-			+ peers.wrapUserNames(data.userIds)
-			+ " to the voice chat";
-	}, [&](const ActionSetMessagesTTL &data) {
-		const auto periodText = (data.period == 7 * 86400)
-			? "7 days"
-			: (data.period == 86400)
-			? "24 hours"
-			: QByteArray();
-		return isChannel
-			? (data.period
-				? "New messages will auto-delete in " + periodText
-				: "New messages will not auto-delete")
-			: (data.period
-				? (serviceFrom
-					+ " has set messages to auto-delete in " + periodText)
-				: (serviceFrom
-					+ " has set messages not to auto-delete"));
-	}, [&](const ActionGroupCallScheduled &data) {
-		const auto dateText = FormatDateTime(data.date);
-		return isChannel
-			? ("Voice chat scheduled for " + dateText)
-			: (serviceFrom + " scheduled a voice chat for " + dateText);
-	}, [&](const ActionSetChatTheme &data) {
-		if (data.emoji.isEmpty()) {
-			return isChannel
-				? "Channel theme was disabled"
-				: (serviceFrom + " disabled chat theme");
-		}
-		return isChannel
-			? ("Channel theme was changed to " + data.emoji).toUtf8()
-			: (serviceFrom + " changed chat theme to " + data.emoji).toUtf8();
-	}, [&](const ActionChatJoinedByRequest &data) {
-		return serviceFrom
-			+ " joined group by request";
-	}, [](v::null_t) { return QByteArray(); });
+	const auto serviceText = ComposeServiceText(
+		message,
+		dialog,
+		peers,
+		wrapMessageLink);
+	const auto info = PrepareMessageInfo(message, serviceText);
 
 	if (!serviceText.isEmpty()) {
 		const auto &content = message.action.content;
@@ -1123,7 +1149,6 @@ auto HtmlWriter::Wrap::pushMessage(
 			serviceText,
 			photo) };
 	}
-	info.type = MessageInfo::Type::Default;
 
 	const auto wrap = messageNeedsWrap(message, previous);
 	const auto fromPeerId = message.fromId;
@@ -1221,7 +1246,9 @@ auto HtmlWriter::Wrap::pushMessage(
 			block.append("In reply to a message in another chat");
 		} else {
 			block.append("In reply to ");
-			block.append(wrapReplyToLink("this message"));
+			block.append(wrapMessageLink(
+				message.replyToMsgId,
+				"this message"));
 		}
 		block.append(popTag());
 	}
@@ -1809,6 +1836,26 @@ bool HtmlWriter::Wrap::forwardedNeedsWrap(
 	return false;
 }
 
+auto HtmlWriter::Wrap::PrepareMessageInfo(
+		const Data::Message &message,
+		const QByteArray &serviceText) -> MessageInfo {
+	auto info = MessageInfo();
+	info.id = message.id;
+	info.fromId = message.fromId;
+	info.viaBotId = message.viaBotId;
+	info.date = message.date;
+	info.forwardedFromId = message.forwardedFromId;
+	info.forwardedFromName = message.forwardedFromName;
+	info.forwardedDate = message.forwardedDate;
+	info.forwarded = message.forwarded;
+	info.showForwardedAsOriginal = message.showForwardedAsOriginal;
+	info.type = (v::is<Data::UnsupportedMedia>(message.media.content)
+		|| !serviceText.isEmpty())
+		? MessageInfo::Type::Service
+		: MessageInfo::Type::Default;
+	return info;
+}
+
 Result HtmlWriter::Wrap::close() {
 	if (!std::exchange(_closed, true) && !_file.empty()) {
 		auto block = QByteArray();
@@ -2394,6 +2441,120 @@ Result HtmlWriter::writeDialogStart(const Data::DialogInfo &data) {
 	return Result::Success();
 }
 
+auto HtmlWriter::renderDialogSlice(const Data::MessagesSlice &data) const
+-> std::vector<std::optional<std::pair<MessageInfo, QByteArray>>> {
+	struct Planned {
+		int index = 0;
+		int previous = -1; // Index in the slice or kPreviousSaved.
+		int filesKnown = 0;
+	};
+	constexpr auto kPreviousSaved = -2;
+
+	// Replay the writeDialogSlice() loop to know the previous message and
+	// the already finished files for each message before rendering.
+	auto planned = std::vector<Planned>();
+	planned.reserve(data.list.size());
+	auto lastMessageIdsPerFile = _lastMessageIdsPerFile;
+	auto messagesCount = _messagesCount;
+	auto oldIndex = (messagesCount > 0)
+		? ((messagesCount - 1) / kMessagesInFile)
+		: 0;
+	auto previous = _lastMessageInfo ? kPreviousSaved : -1;
+	auto lastKept = -1;
+	for (auto i = 0, count = int(data.list.size()); i != count; ++i) {
+		if (Data::SkipMessageByDate(data.list[i], _settings)) {
+			continue;
+		}
+		const auto newIndex = (messagesCount / kMessagesInFile);
+		if (oldIndex != newIndex) {
+			if (lastKept < 0 && !_lastMessageInfo) {
+				return {};
+			}
+			lastMessageIdsPerFile.push_back((lastKept >= 0)
+				? data.list[lastKept].id
+				: _lastMessageInfo->id);
+			previous = -1;
+			oldIndex = newIndex;
+		}
+		planned.push_back({
+			.index = i,
+			.previous = previous,
+			.filesKnown = int(lastMessageIdsPerFile.size()),
+		});
+		previous = lastKept = i;
+		++messagesCount;
+	}
+	const auto parts = std::min(
+		QThread::idealThreadCount(),
+		int(planned.size()) / kParallelRenderMinPart);
+	if (parts < 2) {
+		return {};
+	}
+
+	// A new file starts with the dialog opening, nest the same way.
+	auto prototype = _chat->renderer();
+	if (_chatFileEmpty) {
+		(void)composeDialogOpening(prototype.get(), 0);
+	}
+
+	auto result = std::vector<std::optional<std::pair<MessageInfo, QByteArray>>>(
+		data.list.size());
+	const auto renderPart = [&](int from, int till) {
+		const auto renderer = prototype->renderer();
+		const auto peers = PeersMap(data.peers);
+		auto info = std::optional<MessageInfo>();
+		auto infoIndex = -1;
+		for (auto i = from; i != till; ++i) {
+			const auto &entry = planned[i];
+			const auto wrapper = [&](int messageId, QByteArray text) {
+				return wrapMessageLink(
+					messageId,
+					text,
+					lastMessageIdsPerFile,
+					entry.filesKnown);
+			};
+			if (entry.previous >= 0 && entry.previous != infoIndex) {
+				// First message of the part, info of the previous one is
+				// prepared without rendering it a second time.
+				const auto &message = data.list[entry.previous];
+				info = Wrap::PrepareMessageInfo(
+					message,
+					ComposeServiceText(message, _dialog, peers, wrapper));
+				infoIndex = entry.previous;
+			}
+			auto rendered = renderer->pushMessage(
+				data.list[entry.index],
+				((entry.previous == kPreviousSaved)
+					? _lastMessageInfo.get()
+					: (entry.previous >= 0)
+					? &*info
+					: nullptr),
+				_dialog,
+				_settings.path,
+				peers,
+				_environment.internalLinksDomain,
+				wrapper);
+			info = rendered.first;
+			infoIndex = entry.index;
+			result[entry.index] = std::move(rendered);
+		}
+	};
+
+	const auto count = int(planned.size());
+	auto done = crl::semaphore();
+	for (auto part = 1; part != parts; ++part) {
+		crl::async([&, part] {
+			renderPart(count * part / parts, count * (part + 1) / parts);
+			done.release();
+		});
+	}
+	renderPart(0, count / parts);
+	for (auto part = 1; part != parts; ++part) {
+		done.acquire();
+	}
+	return result;
+}
+
 Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	Expects(_chat != nullptr);
 	Expects(!data.list.empty());
@@ -2401,13 +2562,15 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	const auto messageLinkWrapper = [&](int messageId, QByteArray text) {
 		return wrapMessageLink(messageId, text);
 	};
+	auto rendered = renderDialogSlice(data);
 	auto oldIndex = (_messagesCount > 0)
 		? ((_messagesCount - 1) / kMessagesInFile)
 		: 0;
 	auto previous = _lastMessageInfo.get();
 	auto saved = std::optional<MessageInfo>();
 	auto block = QByteArray();
-	for (const auto &message : data.list) {
+	for (auto i = 0, count = int(data.list.size()); i != count; ++i) {
+		const auto &message = data.list[i];
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
@@ -2443,14 +2606,16 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 				_settings.path,
 				FormatDateText(date)));
 		}
-		const auto [info, content] = _chat->pushMessage(
-			message,
-			previous,
-			_dialog,
-			_settings.path,
-			data.peers,
-			_environment.internalLinksDomain,
-			messageLinkWrapper);
+		const auto [info, content] = rendered.empty()
+			? _chat->pushMessage(
+				message,
+				previous,
+				_dialog,
+				_settings.path,
+				data.peers,
+				_environment.internalLinksDomain,
+				messageLinkWrapper)
+			: std::move(*rendered[i]);
 		block.append(content);
 
 		++_messagesCount;
@@ -2602,25 +2767,31 @@ Result HtmlWriter::writeDialogsEnd() {
 }
 
 Result HtmlWriter::writeDialogOpening(int index) {
+	return _chat->writeBlock(composeDialogOpening(_chat.get(), index));
+}
+
+QByteArray HtmlWriter::composeDialogOpening(
+		not_null<Wrap*> chat,
+		int index) const {
 	const auto name = (_dialog.name.isEmpty()
 		&& _dialog.lastName.isEmpty())
 		? QByteArray("Deleted Account")
 		: (_dialog.name + ' ' + _dialog.lastName);
-	auto block = _chat->pushHeader(
+	auto block = chat->pushHeader(
 		name,
 		_settings.onlySinglePeer() ? QString() : _dialogsRelativePath);
-	block.append(_chat->pushDiv("page_body chat_page"));
-	block.append(_chat->pushDiv("history"));
+	block.append(chat->pushDiv("page_body chat_page"));
+	block.append(chat->pushDiv("history"));
 	if (index > 0) {
 		const auto previousPath = messagesFile(index - 1);
-		block.append(_chat->pushTag("a", {
+		block.append(chat->pushTag("a", {
 			{ "class", "pagination block_link" },
 			{ "href", previousPath.toUtf8() }
 			}));
 		block.append("Previous messages");
-		block.append(_chat->popTag());
+		block.append(chat->popTag());
 	}
-	return _chat->writeBlock(block);
+	return block;
 }
 
 void HtmlWriter::pushSection(
@@ -2668,10 +2839,24 @@ Result HtmlWriter::writeSections() {
 }
 
 QByteArray HtmlWriter::wrapMessageLink(int messageId, QByteArray text) {
-	const auto it = ranges::find_if(_lastMessageIdsPerFile, [&](int maxMessageId) {
+	return wrapMessageLink(
+		messageId,
+		text,
+		_lastMessageIdsPerFile,
+		int(_lastMessageIdsPerFile.size()));
+}
+
+QByteArray HtmlWriter::wrapMessageLink(
+		int messageId,
+		QByteArray text,
+		const std::vector<int> &lastMessageIdsPerFile,
+		int filesKnown) const {
+	const auto from = begin(lastMessageIdsPerFile);
+	const auto till = from + filesKnown;
+	const auto it = std::find_if(from, till, [&](int maxMessageId) {
 		return messageId <= maxMessageId;
 	});
-	if (it == end(_lastMessageIdsPerFile)) {
+	if (it == till) {
 		return "<a href=\"#go_to_message"
 			+ Data::NumberToString(messageId)
 			+ "\" onclick=\"return GoToMessage("
@@ -2679,7 +2864,7 @@ QByteArray HtmlWriter::wrapMessageLink(int messageId, QByteArray text) {
 			+ ")\">"
 			+ text + "</a>";
 	} else {
-		const auto index = it - begin(_lastMessageIdsPerFile);
+		const auto index = it - from;
 		return "<a href=\"" + messagesFile(index).toUtf8()
 			+ "#go_to_message"
 			+ Data::NumberToString(messageId)
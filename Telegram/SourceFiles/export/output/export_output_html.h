@@ -107,6 +107,11 @@ private:
 
 	[[nodiscard]] Result validateDialogsMode(bool isLeftChannel);
 	[[nodiscard]] Result writeDialogOpening(int index);
+	[[nodiscard]] QByteArray composeDialogOpening(
+		not_null<Wrap*> chat,
+		int index) const;
+	[[nodiscard]] auto renderDialogSlice(const Data::MessagesSlice &data) const
+		-> std::vector<std::optional<std::pair<MessageInfo, QByteArray>>>;
 	[[nodiscard]] Result switchToNextChatFile(int index);
 	[[nodiscard]] Result writeEmptySinglePeer();
 
@@ -131,6 +136,11 @@ private:
 	[[nodiscard]] QByteArray wrapMessageLink(
 		int messageId,
 		QByteArray text);
+	[[nodiscard]] QByteArray wrapMessageLink(
+		int messageId,
+		QByteArray text,
+		const std::vector<int> &lastMessageIdsPerFile,
+		int filesKnown) const;
 
 	Settings _settings;
 	Environment _environment;
@@ -12,7 +12,9 @@ namespace Output {
 
 Stats::Stats(const Stats &other)
 : _files(other._files.load())
-, _bytes(other._bytes.load()) {
+, _bytes(other._bytes.load())
+, _skippedFiles(other._skippedFiles.load())
+, _skippedMessages(other._skippedMessages.load()) {
 }
 
 void Stats::incrementFiles() {
@@ -23,6 +25,14 @@ void Stats::incrementBytes(int count) {
 	_bytes += count;
 }
 
+void Stats::incrementSkippedFiles() {
+	++_skippedFiles;
+}
+
+void Stats::incrementSkippedMessages(int count) {
+	_skippedMessages += count;
+}
+
 int Stats::filesCount() const {
 	return _files;
 }
@@ -31,5 +41,13 @@ int64 Stats::bytesCount() const {
 	return _bytes;
 }
 
+int Stats::skippedFilesCount() const {
+	return _skippedFiles;
+}
+
+int Stats::skippedMessagesCount() const {
+	return _skippedMessages;
+}
+
 } // namespace Output
 } // namespace Export
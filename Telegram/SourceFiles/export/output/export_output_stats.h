@@ -20,12 +20,20 @@ public:
 	void incrementFiles();
 	void incrementBytes(int count);
 
+	// Incremental export: already written by one of the previous runs.
+	void incrementSkippedFiles();
+	void incrementSkippedMessages(int count);
+
 	int filesCount() const;
 	int64 bytesCount() const;
+	int skippedFilesCount() const;
+	int skippedMessagesCount() const;
 
 private:
 	std::atomic<int> _files;
 	std::atomic<int64> _bytes;
+	std::atomic<int> _skippedFiles;
+	std::atomic<int> _skippedMessages;
 
 };
 
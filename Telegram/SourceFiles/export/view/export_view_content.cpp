@@ -156,6 +156,26 @@ Content ContentFromState(const FinishedState &state) {
 			Ui::FormatSizeText(state.bytesCount)),
 		QString(),
 		1. });
+	if (state.skippedMessagesCount > 0) {
+		result.rows.push_back({
+			Content::kDoneId,
+			tr::lng_export_skipped_messages(
+				tr::now,
+				lt_amount,
+				QString::number(state.skippedMessagesCount)),
+			QString(),
+			1. });
+	}
+	if (state.skippedFilesCount > 0) {
+		result.rows.push_back({
+			Content::kDoneId,
+			tr::lng_export_skipped_files(
+				tr::now,
+				lt_amount,
+				QString::number(state.skippedFilesCount)),
+			QString(),
+			1. });
+	}
 	return result;
 }
 
@@ -250,6 +250,7 @@ void SettingsWidget::setupPathAndFormat(
 	if (_singlePeerId != 0) {
 		addFormatAndLocationLabel(container);
 		addLimitsLabel(container);
+		addIncrementalOption(container);
 		return;
 	}
 	const auto formatGroup = std::make_shared<Ui::RadioenumGroup<Format>>(
@@ -273,6 +274,30 @@ void SettingsWidget::setupPathAndFormat(
 	addLocationLabel(container);
 	addFormatOption(tr::lng_export_option_html(tr::now), Format::Html);
 	addFormatOption(tr::lng_export_option_json(tr::now), Format::Json);
+	addIncrementalOption(container);
+}
+
+void SettingsWidget::addIncrementalOption(
+		not_null<Ui::VerticalLayout*> container) {
+	const auto checkbox = container->add(
+		object_ptr<Ui::Checkbox>(
+			container,
+			tr::lng_export_option_incremental(tr::now),
+			readData().incremental,
+			st::defaultBoxCheckbox),
+		st::exportSettingPadding);
+	checkbox->checkedChanges(
+	) | rpl::start_with_next([=](bool checked) {
+		changeData([&](Settings &data) {
+			data.incremental = checked;
+		});
+	}, checkbox->lifetime());
+	container->add(
+		object_ptr<Ui::FlatLabel>(
+			container,
+			tr::lng_export_option_incremental_about(tr::now),
+			st::exportAboutOptionLabel),
+		st::exportAboutOptionPadding);
 }
 
 void SettingsWidget::addLocationLabel(
@@ -380,6 +380,7 @@ std::vector<not_null<HistoryItem*>> History::createItems(
 	result.reserve(data.size());
 	const auto localFlags = MessageFlags();
 	const auto detachExistingItem = true;
+	const auto started = crl::now();
 	for (auto i = data.cend(), e = data.cbegin(); i != e;) {
 		const auto &data = *--i;
 		result.emplace_back(createItem(
@@ -388,6 +389,9 @@ std::vector<not_null<HistoryItem*>> History::createItems(
 			localFlags,
 			detachExistingItem));
 	}
+	DEBUG_LOG(("History: %1 slice items created in %2 ms."
+		).arg(result.size()
+		).arg(crl::now() - started));
 	return result;
 }
 
@@ -1258,17 +1262,24 @@ void History::addOlderSlice(const QVector<MTPMessage> &slice) {
 
 void History::addCreatedOlderSlice(
 		const std::vector<not_null<HistoryItem*>> &items) {
+	const auto started = crl::now();
 	startBuildingFrontBlock(items.size());
 	for (const auto &item : items) {
 		addItemToBlock(item);
 	}
 	finishBuildingFrontBlock();
+	const auto built = crl::now();
 
 	if (loadedAtBottom()) {
 		// Add photos to overview and authors to lastAuthors.
 		addItemsToLists(items);
 	}
 	addToSharedMedia(items);
+	DEBUG_LOG(("History: %1 older slice items added to blocks in %2 ms, "
+		"to lists in %3 ms."
+		).arg(items.size()
+		).arg(built - started
+		).arg(crl::now() - built));
 }
 
 void History::addNewerSlice(const QVector<MTPMessage> &slice) {
@@ -1284,11 +1295,18 @@ void History::addNewerSlice(const QVector<MTPMessage> &slice) {
 	if (const auto added = createItems(slice); !added.empty()) {
 		Assert(!isBuildingFrontBlock());
 
+		const auto started = crl::now();
 		for (const auto &item : added) {
 			addItemToBlock(item);
 		}
+		const auto built = crl::now();
 
 		addToSharedMedia(added);
+		DEBUG_LOG(("History: %1 newer slice items added to blocks in %2 ms, "
+			"to lists in %3 ms."
+			).arg(added.size()
+			).arg(built - started
+			).arg(crl::now() - built));
 	} else {
 		_loadedAtBottom = true;
 		setLastMessage(lastAvailableMessage());
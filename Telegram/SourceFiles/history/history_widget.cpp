@@ -2222,8 +2222,13 @@ void HistoryWidget::setHistory(History *history) {
 		return;
 	}
 	unregisterDraftSources();
+	_historyShownLifetime.destroy();
 	_history = history;
 	_migrated = _history ? _history->migrateFrom() : nullptr;
+	if (_history) {
+		_historyShownLifetime = _history->owner().histories().historyShown(
+			_history);
+	}
 	registerDraftSource();
 }
 
@@ -7336,6 +7341,7 @@ HistoryWidget::~HistoryWidget() {
 
 		clearAllLoadRequests();
 		unregisterDraftSources();
+		_historyShownLifetime.destroy();
 	}
 	setTabbedPanel(nullptr);
 }
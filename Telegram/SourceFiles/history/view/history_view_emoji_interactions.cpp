@@ -146,7 +146,9 @@ std::unique_ptr<Lottie::SinglePlayer> EmojiInteractions::preparePlayer(
 		crl::on_main(weak, [=, data = std::move(cached)]() mutable {
 			weak->data().cacheBigFile().put(
 				{ key.high, key.low + i },
-				std::move(data));
+				Storage::Cache::Database::TaggedValue(
+					std::move(data),
+					weak->data().cacheBigFileTag()));
 		});
 	};
 	const auto data = media->bytes();
@@ -48,6 +48,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/call_delayed.h"
 #include "core/file_utilities.h"
 #include "main/main_session.h"
+#include "data/data_histories.h"
 #include "data/data_session.h"
 #include "data/data_user.h"
 #include "data/data_chat.h"
@@ -177,6 +178,8 @@ RepliesWidget::RepliesWidget(
 		_scroll->updateBars();
 	}, _scroll->lifetime());
 
+	lifetime().add(_history->owner().histories().historyShown(_history));
+
 	Window::ChatThemeValueFromPeer(
 		controller,
 		history->peer
@@ -43,6 +43,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/call_delayed.h"
 #include "core/file_utilities.h"
 #include "main/main_session.h"
+#include "data/data_histories.h"
 #include "data/data_session.h"
 #include "data/data_scheduled_messages.h"
 #include "data/data_user.h"
@@ -112,6 +113,8 @@ ScheduledWidget::ScheduledWidget(
 		_scroll->updateBars();
 	}, _scroll->lifetime());
 
+	lifetime().add(_history->owner().histories().historyShown(_history));
+
 	Window::ChatThemeValueFromPeer(
 		controller,
 		history->peer
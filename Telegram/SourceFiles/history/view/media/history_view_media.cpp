@@ -188,7 +188,7 @@ PointState Media::pointState(QPoint point) const {
 		: PointState::Outside;
 }
 
-std::unique_ptr<Lottie::SinglePlayer> Media::stickerTakeLottie(
+std::shared_ptr<Lottie::SinglePlayer> Media::stickerTakeLottie(
 		not_null<DocumentData*> data,
 		const Lottie::ColorReplacements *replacements) {
 	return nullptr;
@@ -158,7 +158,7 @@ public:
 	}
 	virtual void stickerClearLoopPlayed() {
 	}
-	virtual std::unique_ptr<Lottie::SinglePlayer> stickerTakeLottie(
+	virtual std::shared_ptr<Lottie::SinglePlayer> stickerTakeLottie(
 		not_null<DocumentData*> data,
 		const Lottie::ColorReplacements *replacements);
 	virtual void checkAnimation() {
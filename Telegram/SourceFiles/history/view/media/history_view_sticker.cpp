@@ -159,7 +159,7 @@ void Sticker::paintLottie(
 		const QRect &r) {
 	auto request = Lottie::FrameRequest();
 	request.box = _size * cIntRetinaFactor();
-	if (context.selected() && !_nextLastDiceFrame) {
+	if (context.selected() && !_nextLastDiceFrame && !_lottieShared) {
 		request.colored = context.st->msgStickerOverlay()->c;
 	}
 	const auto frame = _lottie
@@ -172,7 +172,11 @@ void Sticker::paintLottie(
 	const auto &image = _lastDiceFrame.isNull()
 		? frame.image
 		: _lastDiceFrame;
-	const auto prepared = (!_lastDiceFrame.isNull() && context.selected())
+	// Shared players render frames for all views with the same request,
+	// so selected views color the shared frame by themselves.
+	const auto colorize = context.selected()
+		&& (!_lastDiceFrame.isNull() || _lottieShared);
+	const auto prepared = colorize
 		? Images::prepareColored(context.st->msgStickerOverlay()->c, image)
 		: image;
 	const auto size = prepared.size() / cIntRetinaFactor();
@@ -205,7 +209,11 @@ void Sticker::paintLottie(
 		|| (!lastDiceFrame && (frame.index != 0 || !_lottieOncePlayed));
 	if (!paused
 		&& switchToNext
-		&& _lottie->markFrameShown()
+		&& (_lottieShared
+			? ChatHelpers::LottieSharedPlayerMarkFrameShown(
+				_lottie.get(),
+				frame.index)
+			: _lottie->markFrameShown())
 		&& playOnce
 		&& !_lottieOncePlayed) {
 		_lottieOncePlayed = true;
@@ -347,12 +355,26 @@ void Sticker::setDiceIndex(const QString &emoji, int index) {
 void Sticker::setupLottie() {
 	Expects(_dataMedia != nullptr);
 
-	_lottie = ChatHelpers::LottiePlayerFromDocument(
-		_dataMedia.get(),
-		_replacements,
-		ChatHelpers::StickerLottieSize::MessageHistory,
-		size() * cIntRetinaFactor(),
-		Lottie::Quality::High);
+	// Play-once stickers decide by themselves when to stop the animation,
+	// so only looping ones can share a player between views.
+	_lottieShared = (_diceIndex < 0)
+		&& !isEmojiSticker()
+		&& Core::App().settings().loopAnimatedStickers();
+	if (_lottieShared) {
+		_lottie = ChatHelpers::LottieSharedPlayerFromDocument(
+			_dataMedia.get(),
+			_replacements,
+			ChatHelpers::StickerLottieSize::MessageHistory,
+			size() * cIntRetinaFactor(),
+			Lottie::Quality::High);
+	} else {
+		_lottie = ChatHelpers::LottiePlayerFromDocument(
+			_dataMedia.get(),
+			_replacements,
+			ChatHelpers::StickerLottieSize::MessageHistory,
+			size() * cIntRetinaFactor(),
+			Lottie::Quality::High);
+	}
 	lottieCreated();
 }
 
@@ -392,10 +414,11 @@ void Sticker::unloadLottie() {
 	_parent->checkHeavyPart();
 }
 
-std::unique_ptr<Lottie::SinglePlayer> Sticker::stickerTakeLottie(
+std::shared_ptr<Lottie::SinglePlayer> Sticker::stickerTakeLottie(
 		not_null<DocumentData*> data,
 		const Lottie::ColorReplacements *replacements) {
-	return (data == _data && replacements == _replacements)
+	// A shared player is found again by the new view itself.
+	return (data == _data && replacements == _replacements && !_lottieShared)
 		? std::move(_lottie)
 		: nullptr;
 }
@@ -53,7 +53,7 @@ public:
 	void stickerClearLoopPlayed() override {
 		_lottieOncePlayed = false;
 	}
-	std::unique_ptr<Lottie::SinglePlayer> stickerTakeLottie(
+	std::shared_ptr<Lottie::SinglePlayer> stickerTakeLottie(
 		not_null<DocumentData*> data,
 		const Lottie::ColorReplacements *replacements) override;
 
@@ -99,7 +99,7 @@ private:
 	const not_null<Element*> _parent;
 	const not_null<DocumentData*> _data;
 	const Lottie::ColorReplacements *_replacements = nullptr;
-	std::unique_ptr<Lottie::SinglePlayer> _lottie;
+	std::shared_ptr<Lottie::SinglePlayer> _lottie;
 	mutable std::shared_ptr<Data::DocumentMedia> _dataMedia;
 	ClickHandlerPtr _link;
 	QSize _size;
@@ -110,6 +110,7 @@ private:
 	mutable int _framesCount = -1;
 	mutable bool _lottieOncePlayed = false;
 	mutable bool _nextLastDiceFrame = false;
+	bool _lottieShared = false;
 
 	rpl::lifetime _lifetime;
 
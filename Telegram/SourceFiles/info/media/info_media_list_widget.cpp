@@ -56,6 +56,8 @@ constexpr auto kPreloadIfLessThanScreens = 2;
 constexpr auto kPreloadedScreensCountFull
 	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
 constexpr auto kMediaCountForSearch = 10;
+constexpr auto kPrepareThumbnailsScreens = 1;
+constexpr auto kThumbnailsCacheLimit = int64(32 * 1024 * 1024);
 
 UniversalMsgId GetUniversalId(FullMsgId itemId) {
 	return (itemId.channel != 0)
@@ -161,6 +163,7 @@ public:
 		const Context &context,
 		QRect clip,
 		int outerWidth) const;
+	void prepareThumbnails(int top, int bottom) const;
 
 	void paintFloatingHeader(Painter &p, int visibleTop, int outerWidth);
 
@@ -506,6 +509,17 @@ void ListWidget::Section::paint(
 	}
 }
 
+void ListWidget::Section::prepareThumbnails(int top, int bottom) const {
+	if (!_mosaic.empty()) {
+		return;
+	}
+	auto fromIt = findItemAfterTop(top);
+	auto tillIt = findItemAfterBottom(fromIt, bottom);
+	for (auto it = fromIt; it != tillIt; ++it) {
+		it->second->prepareThumbnail();
+	}
+}
+
 void ListWidget::Section::paintFloatingHeader(
 		Painter &p,
 		int visibleTop,
@@ -764,6 +778,8 @@ void ListWidget::restart() {
 	_sections.clear();
 	_layouts.clear();
 	_heavyLayouts.clear();
+	_thumbnails.clear();
+	_thumbnailsBytes = 0;
 
 	_universalAroundId = kDefaultAroundId;
 	_idsLimit = kMinimalIdsLimit;
@@ -795,6 +811,7 @@ void ListWidget::itemRemoved(not_null<const HistoryItem*> item) {
 
 	if (const auto i = _layouts.find(id); i != _layouts.end()) {
 		_heavyLayouts.remove(i->second.item.get());
+		forgetThumbnail(i->second.item.get());
 		_layouts.erase(i);
 	}
 	_dragSelected.remove(id);
@@ -891,6 +908,27 @@ void ListWidget::itemLayoutChanged(
 	}
 }
 
+void ListWidget::registerThumbnail(
+		not_null<const BaseLayout*> item,
+		int64 bytes) {
+	auto &cached = _thumbnails[item];
+	_thumbnailsBytes += bytes - cached;
+	cached = bytes;
+	if (_thumbnailsBytes > kThumbnailsCacheLimit
+		&& !_thumbnailsClearScheduled) {
+		// Items register thumbnails while being painted.
+		_thumbnailsClearScheduled = true;
+		crl::on_main(this, [=] { clearThumbnails(); });
+	}
+}
+
+void ListWidget::forgetThumbnail(not_null<const BaseLayout*> item) {
+	if (const auto i = _thumbnails.find(item); i != _thumbnails.end()) {
+		_thumbnailsBytes -= i->second;
+		_thumbnails.erase(i);
+	}
+}
+
 void ListWidget::repaintItem(const HistoryItem *item) {
 	if (item && isMyItem(item)) {
 		repaintItem(GetUniversalId(item));
@@ -1227,6 +1265,7 @@ void ListWidget::visibleTopBottomUpdated(
 
 	checkMoveToOtherViewer();
 	clearHeavyItems();
+	prepareThumbnails();
 
 	if (_dateBadge->goodType) {
 		updateDateBadgeFor(_visibleTop);
@@ -1363,6 +1402,62 @@ void ListWidget::clearHeavyItems() {
 	}
 }
 
+void ListWidget::prepareThumbnails() {
+	const auto visibleHeight = _visibleBottom - _visibleTop;
+	if (visibleHeight <= 0) {
+		return;
+	}
+	const auto prepare = [&](int from, int till) {
+		const auto fromSectionIt = findSectionAfterTop(from);
+		const auto tillSectionIt = findSectionAfterBottom(
+			fromSectionIt,
+			till);
+		for (auto it = fromSectionIt; it != tillSectionIt; ++it) {
+			const auto top = it->top();
+			it->prepareThumbnails(from - top, till - top);
+		}
+	};
+	const auto distance = kPrepareThumbnailsScreens * visibleHeight;
+	prepare(_visibleBottom, _visibleBottom + distance);
+	prepare(_visibleTop - distance, _visibleTop);
+}
+
+void ListWidget::clearThumbnails() {
+	_thumbnailsClearScheduled = false;
+	const auto visibleHeight = _visibleBottom - _visibleTop;
+	if (_thumbnailsBytes <= kThumbnailsCacheLimit || visibleHeight <= 0) {
+		return;
+	}
+
+	// Drop the thumbnails farthest from the visible range first, but never
+	// the ones we keep prepared around it.
+	const auto distance = kPrepareThumbnailsScreens * visibleHeight;
+	const auto above = _visibleTop - distance;
+	const auto below = _visibleBottom + distance;
+	const auto middle = (_visibleTop + _visibleBottom) / 2;
+	auto far = std::vector<std::pair<int, not_null<BaseLayout*>>>();
+	far.reserve(_thumbnails.size());
+	for (const auto &[item, bytes] : _thumbnails) {
+		const auto layout = const_cast<BaseLayout*>(item.get());
+		const auto rect = findItemDetails(layout).geometry;
+		if (rect.top() + rect.height() <= above || rect.top() >= below) {
+			far.emplace_back(std::abs(rect.center().y() - middle), layout);
+		}
+	}
+	ranges::sort(far, std::greater<>(), [](const auto &pair) {
+		return pair.first;
+	});
+
+	const auto enough = (kThumbnailsCacheLimit * 3) / 4;
+	for (const auto &[delta, layout] : far) {
+		if (_thumbnailsBytes <= enough) {
+			break;
+		}
+		layout->clearThumbnail();
+		forgetThumbnail(layout);
+	}
+}
+
 auto ListWidget::countScrollState() const -> ScrollTopState {
 	if (_sections.empty()) {
 		return { 0, 0 };
@@ -2415,6 +2510,7 @@ void ListWidget::clearStaleLayouts() {
 				_overLayout = nullptr;
 			}
 			_heavyLayouts.erase(i->second.item.get());
+			forgetThumbnail(i->second.item.get());
 			i = _layouts.erase(i);
 		} else {
 			++i;
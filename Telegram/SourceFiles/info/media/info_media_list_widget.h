@@ -79,6 +79,9 @@ public:
 	// Overview::Layout::Delegate
 	void registerHeavyItem(not_null<const BaseLayout*> item) override;
 	void unregisterHeavyItem(not_null<const BaseLayout*> item) override;
+	void registerThumbnail(
+		not_null<const BaseLayout*> item,
+		int64 bytes) override;
 	void repaintItem(not_null<const BaseLayout*> item) override;
 	bool itemVisible(not_null<const BaseLayout*> item) override;
 
@@ -291,6 +294,9 @@ private:
 	void validateTrippleClickStartTime();
 	void checkMoveToOtherViewer();
 	void clearHeavyItems();
+	void prepareThumbnails();
+	void forgetThumbnail(not_null<const BaseLayout*> item);
+	void clearThumbnails();
 
 	void setActionBoxWeak(QPointer<Ui::RpWidget> box);
 
@@ -308,6 +314,9 @@ private:
 	std::unordered_map<UniversalMsgId, CachedItem> _layouts;
 	base::flat_set<not_null<const BaseLayout*>> _heavyLayouts;
 	bool _heavyLayoutsInvalidated = false;
+	base::flat_map<not_null<const BaseLayout*>, int64> _thumbnails;
+	int64 _thumbnailsBytes = 0;
+	bool _thumbnailsClearScheduled = false;
 	std::vector<Section> _sections;
 
 	int _visibleTop = 0;
@@ -243,6 +243,7 @@ struct Instance::PrivateTag {
 
 Instance::Instance()
 : _values(PrepareDefaultValues())
+, _unparsedValues(kKeysCount)
 , _nonDefaultSet(kKeysCount, 0) {
 }
 
@@ -302,6 +303,7 @@ void Instance::reset(const Language &data) {
 	for (auto i = 0, count = int(_values.size()); i != count; ++i) {
 		_values[i] = GetOriginalValue(ushort(i));
 	}
+	ranges::fill(_unparsedValues, UnparsedValue());
 	ranges::fill(_nonDefaultSet, 0);
 	updateChoosingStickerReplacement();
 
@@ -734,22 +736,64 @@ QString Instance::getNonDefaultValue(const QByteArray &key) const {
 
 void Instance::applyValue(const QByteArray &key, const QByteArray &value) {
 	_nonDefaultValues[key] = value;
-	ParseKeyValue(key, value, [&](ushort key, QString &&value) {
-		_nonDefaultSet[key] = 1;
+
+	// Only the key is resolved here, the value is parsed in getValue().
+	const auto index = GetKeyIndex(QLatin1String(key));
+	if (index == kKeysCount) {
+		if (!key.startsWith("cloud_")) {
+			DEBUG_LOG(("Lang Warning: Unknown key '%1'"
+				).arg(QString::fromLatin1(key)));
+		}
+		return;
+	}
+	_nonDefaultSet[index] = 1;
+	if (!_derived) {
+		setUnparsedValue(index, key, value);
+	} else if (!_derived->_nonDefaultSet[index]) {
+		_derived->setUnparsedValue(index, key, value);
+	}
+	if (index == tr::lng_send_action_choose_sticker.base
+		|| index == tr::lng_user_action_choose_sticker.base) {
 		if (!_derived) {
-			_values[key] = std::move(value);
-		} else if (!_derived->_nonDefaultSet[key]) {
-			_derived->_values[key] = std::move(value);
+			updateChoosingStickerReplacement();
+		} else {
+			_derived->updateChoosingStickerReplacement();
 		}
-		if (key == tr::lng_send_action_choose_sticker.base
-			|| key == tr::lng_user_action_choose_sticker.base) {
-			if (!_derived) {
-				updateChoosingStickerReplacement();
-			} else {
-				_derived->updateChoosingStickerReplacement();
+	}
+}
+
+void Instance::setUnparsedValue(
+		ushort keyIndex,
+		const QByteArray &key,
+		const QByteArray &value) {
+	Expects(!_derived);
+
+	_unparsedValues[keyIndex] = UnparsedValue{ key, value };
+}
+
+void Instance::parseValue(ushort key) const {
+	Expects(!_derived);
+
+	const auto unparsed = base::take(_unparsedValues[key]);
+	auto parser = ValueParser(unparsed.key, key, unparsed.value);
+	if (parser.parse()) {
+		_values[key] = parser.takeResult();
+		return;
+	}
+
+	// The value of the base pack is used if the current one is invalid.
+	if (_base) {
+		const auto &values = _base->_nonDefaultValues;
+		const auto i = values.find(unparsed.key);
+		if (i != end(values) && i->second != unparsed.value) {
+			auto parser = ValueParser(unparsed.key, key, i->second);
+			if (parser.parse()) {
+				_values[key] = parser.takeResult();
+				return;
 			}
 		}
-	});
+	}
+	_values[key] = GetOriginalValue(key);
 }
 
 void Instance::updatePluralRules() {
@@ -770,6 +814,7 @@ void Instance::resetValue(const QByteArray &key) {
 	if (keyIndex != kKeysCount) {
 		_nonDefaultSet[keyIndex] = 0;
 		if (!_derived) {
+			_unparsedValues[keyIndex] = UnparsedValue();
 			const auto base = _base
 				? _base->getNonDefaultValue(key)
 				: QString();
@@ -777,6 +822,7 @@ void Instance::resetValue(const QByteArray &key) {
 				? base
 				: GetOriginalValue(keyIndex);
 		} else if (!_derived->_nonDefaultSet[keyIndex]) {
+			_derived->_unparsedValues[keyIndex] = UnparsedValue();
 			_derived->_values[keyIndex] = GetOriginalValue(keyIndex);
 		}
 		if (keyIndex == tr::lng_send_action_choose_sticker.base
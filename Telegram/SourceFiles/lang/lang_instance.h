@@ -92,6 +92,9 @@ public:
 	QString getValue(ushort key) const {
 		Expects(key < _values.size());
 
+		if (!_unparsedValues[key].key.isEmpty()) {
+			parseValue(key);
+		}
 		return _values[key];
 	}
 	QString getNonDefaultValue(const QByteArray &key) const;
@@ -108,7 +111,17 @@ public:
 	}
 
 private:
+	struct UnparsedValue {
+		QByteArray key;
+		QByteArray value;
+	};
+
 	void setBaseId(const QString &baseId, const QString &pluralId);
+	void parseValue(ushort key) const;
+	void setUnparsedValue(
+		ushort keyIndex,
+		const QByteArray &key,
+		const QByteArray &value);
 
 	void applyDifferenceToMe(const MTPDlangPackDifference &difference);
 	void applyValue(const QByteArray &key, const QByteArray &value);
@@ -146,7 +159,10 @@ private:
 
 	mutable QString _systemLanguage;
 
-	std::vector<QString> _values;
+	// Applied values are kept in the pack encoding until first requested,
+	// most of the keys are never shown in a session.
+	mutable std::vector<QString> _values;
+	mutable std::vector<UnparsedValue> _unparsedValues;
 	std::vector<uchar> _nonDefaultSet;
 	std::map<QByteArray, QByteArray> _nonDefaultValues;
 
@@ -49,6 +49,7 @@ constexpr auto kWideIdsTag = ~uint64(0);
 
 Account::Account(not_null<Domain*> domain, const QString &dataName, int index)
 : _domain(domain)
+, _index(index)
 , _local(std::make_unique<Storage::Account>(
 	this,
 	ComposeDataString(dataName, index))) {
@@ -236,6 +237,13 @@ rpl::producer<not_null<MTP::Instance*>> Account::mtpValue() const {
 	});
 }
 
+int Account::mtpConnectionsCount() const {
+	return (_mtp ? _mtp->connectedSessionsCount() : 0)
+		+ (_mtpForKeysDestroy
+			? _mtpForKeysDestroy->connectedSessionsCount()
+			: 0);
+}
+
 rpl::producer<not_null<MTP::Instance*>> Account::mtpMainSessionValue() const {
 	return mtpValue() | rpl::map([=](not_null<MTP::Instance*> instance) {
 		return instance->mainDcIdValue() | rpl::map_to(instance);
@@ -412,6 +420,7 @@ void Account::startMtp(std::unique_ptr<MTP::Config> config) {
 	fields.config = std::move(config);
 	fields.deviceModel = Platform::DeviceModelPretty();
 	fields.systemVersion = Platform::SystemVersionPretty();
+	fields.threads = _domain->mtpThreads();
 	_mtp = std::make_unique<MTP::Instance>(
 		MTP::Instance::Mode::Normal,
 		std::move(fields));
@@ -558,6 +567,7 @@ void Account::destroyMtpKeys(MTP::AuthKeysList &&keys) {
 	destroyFields.keys = std::move(keys);
 	destroyFields.deviceModel = Platform::DeviceModelPretty();
 	destroyFields.systemVersion = Platform::SystemVersionPretty();
+	destroyFields.threads = _domain->mtpThreads();
 	_mtpForKeysDestroy = std::make_unique<MTP::Instance>(
 		MTP::Instance::Mode::KeysDestroyer,
 		std::move(destroyFields));
@@ -37,6 +37,9 @@ public:
 	[[nodiscard]] Domain &domain() const {
 		return *_domain;
 	}
+	[[nodiscard]] int index() const {
+		return _index;
+	}
 
 	[[nodiscard]] Storage::Domain &domainLocal() const;
 
@@ -82,6 +85,7 @@ public:
 		return *_mtp;
 	}
 	[[nodiscard]] rpl::producer<not_null<MTP::Instance*>> mtpValue() const;
+	[[nodiscard]] int mtpConnectionsCount() const;
 
 	// Each time the main session changes a new copy of the pointer is fired.
 	// This allows to resend the requests that were not requiring auth, and
@@ -139,6 +143,7 @@ private:
 	void destroySession(DestroyReason reason);
 
 	const not_null<Domain*> _domain;
+	const int _index = 0;
 	const std::unique_ptr<Storage::Account> _local;
 
 	std::unique_ptr<MTP::Instance> _mtp;
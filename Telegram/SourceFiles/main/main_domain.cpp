@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_domain.h"
 
 #include "core/application.h"
+#include "core/core_settings.h"
 #include "core/shortcuts.h"
 #include "core/crash_reports.h"
 #include "main/main_account.h"
@@ -17,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_user.h"
 #include "mtproto/mtproto_config.h"
 #include "mtproto/mtproto_dc_options.h"
+#include "mtproto/session_threads.h"
 #include "storage/storage_domain.h"
 #include "storage/storage_account.h"
 #include "storage/localstorage.h"
@@ -134,6 +136,7 @@ void Domain::activateAfterStarting() {
 
 	activate(toActivate);
 	removePasscodeIfEmpty();
+	clearSharedCacheBigFileIfUnused();
 }
 
 const std::vector<Domain::AccountWithIndex> &Domain::accounts() const {
@@ -312,6 +315,7 @@ void Domain::watchSession(not_null<Account*> account) {
 		return !session;
 	}) | rpl::start_with_next([=] {
 		scheduleUpdateUnreadBadge();
+		releaseSharedCacheBigFile(account);
 		if (account == _active.current()) {
 			activateAuthedAccount();
 		}
@@ -321,6 +325,105 @@ void Domain::watchSession(not_null<Account*> account) {
 	}, account->lifetime());
 }
 
+Storage::DatabasePointer Domain::sharedCacheBigFile(
+		not_null<Account*> account) {
+	const auto path = _local->sharedCacheBigFilePath();
+	const auto settings = account->local().cacheBigFileSettings();
+	if (!_sharedBigFileCache) {
+		_sharedBigFileCache.emplace(
+			Core::App().databases().get(path, settings));
+		(*_sharedBigFileCache)->open(_local->sharedCacheBigFileKey());
+		_sharedBigFileCacheLimits.totalSizeLimit = settings.totalSizeLimit;
+		_sharedBigFileCacheLimits.totalTimeLimit = settings.totalTimeLimit;
+	}
+	_sharedBigFileCacheUsers[account] = settings;
+	refreshSharedCacheBigFileSettings();
+	return Core::App().databases().get(path, settings);
+}
+
+std::shared_ptr<MTP::SessionThreads> Domain::mtpThreads() {
+	if (!_mtpThreads) {
+		_mtpThreads = std::make_shared<MTP::SessionThreads>();
+	}
+	return _mtpThreads;
+}
+
+auto Domain::transportStats() const -> TransportStats {
+	auto result = TransportStats{
+		.threads = _mtpThreads ? _mtpThreads->startedCount() : 0,
+	};
+	for (const auto &[index, account] : _accounts) {
+		result.connections += account->mtpConnectionsCount();
+	}
+	return result;
+}
+
+void Domain::updateSharedCacheBigFileSettings(not_null<Account*> account) {
+	const auto i = _sharedBigFileCacheUsers.find(account);
+	if (i != end(_sharedBigFileCacheUsers)) {
+		i->second = account->local().cacheBigFileSettings();
+		refreshSharedCacheBigFileSettings();
+	}
+}
+
+void Domain::releaseSharedCacheBigFile(not_null<Account*> account) {
+	if (_sharedBigFileCacheUsers.remove(account)) {
+		refreshSharedCacheBigFileSettings();
+		clearSharedCacheBigFileIfUnused();
+	}
+}
+
+void Domain::clearSharedCacheBigFileIfUnused() {
+	if (Core::App().settings().sharedMediaCache()
+		|| !_sharedBigFileCacheUsers.empty()) {
+		return;
+	} else if (_sharedBigFileCache
+		|| QDir(_local->sharedCacheBigFilePath()).exists()) {
+		clearSharedCacheBigFile();
+	}
+}
+
+void Domain::refreshSharedCacheBigFileSettings() {
+	if (!_sharedBigFileCache || _sharedBigFileCacheUsers.empty()) {
+		return;
+	}
+
+	// Each account keeps its own limits, the shared cache
+	// is evicted by the most generous of them, zero time means forever.
+	auto update = Storage::Cache::Database::SettingsUpdate();
+	update.totalSizeLimit = 0;
+	update.totalTimeLimit = -1;
+	for (const auto &[account, settings] : _sharedBigFileCacheUsers) {
+		update.totalSizeLimit = std::max(
+			update.totalSizeLimit,
+			settings.totalSizeLimit);
+		update.totalTimeLimit = (update.totalTimeLimit < 0)
+			? settings.totalTimeLimit
+			: (!update.totalTimeLimit || !settings.totalTimeLimit)
+			? 0
+			: std::max(update.totalTimeLimit, settings.totalTimeLimit);
+	}
+	if (update.totalSizeLimit == _sharedBigFileCacheLimits.totalSizeLimit
+		&& update.totalTimeLimit == _sharedBigFileCacheLimits.totalTimeLimit) {
+		return;
+	}
+	_sharedBigFileCacheLimits = update;
+	(*_sharedBigFileCache)->updateSettings(update);
+}
+
+void Domain::clearSharedCacheBigFile() {
+	if (!_sharedBigFileCache) {
+		_sharedBigFileCache.emplace(Core::App().databases().get(
+			_local->sharedCacheBigFilePath(),
+			Storage::Cache::Database::Settings()));
+	}
+	(*_sharedBigFileCache)->close();
+	(*_sharedBigFileCache)->clear();
+	_sharedBigFileCache = std::nullopt;
+	_sharedBigFileCacheUsers.clear();
+	_sharedBigFileCacheLimits = {};
+}
+
 void Domain::activateAuthedAccount() {
 	Expects(started());
 
@@ -340,6 +443,7 @@ bool Domain::removePasscodeIfEmpty() {
 		return false;
 	}
 	Local::reset();
+	clearSharedCacheBigFile();
 
 	// We completely logged out, remove the passcode if it was there.
 	if (Core::App().passcodeLocked()) {
@@ -413,6 +517,12 @@ void Domain::activate(not_null<Main::Account*> account) {
 	}
 	_accountToActivate = i->index;
 	_active = account.get();
+
+	const auto stats = transportStats();
+	LOG(("MTP Info: %1 accounts use %2 threads and %3 connections."
+		).arg(_accounts.size()
+		).arg(stats.threads
+		).arg(stats.connections));
 	_active.current()->sessionValue(
 	) | rpl::start_to_stream(_activeSessions, _activeLifetime);
 
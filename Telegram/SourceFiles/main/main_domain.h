@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/timer.h"
+#include "storage/storage_databases.h"
 
 namespace Storage {
 class Domain;
@@ -16,6 +17,7 @@ enum class StartResult : uchar;
 
 namespace MTP {
 enum class Environment : uchar;
+class SessionThreads;
 } // namespace MTP
 
 namespace Main {
@@ -67,6 +69,24 @@ public:
 	void activate(not_null<Main::Account*> account);
 	void addActivated(MTP::Environment environment);
 
+	// Media cache shared by the accounts, if enabled in Core::Settings.
+	// The size and time limits are the largest ones of the sessions using it.
+	[[nodiscard]] Storage::DatabasePointer sharedCacheBigFile(
+		not_null<Account*> account);
+	void updateSharedCacheBigFileSettings(not_null<Account*> account);
+
+	// Removes the shared media cache if it is off and nobody uses it.
+	void clearSharedCacheBigFileIfUnused();
+
+	// Connection threads shared by the MTP instances of all the accounts.
+	[[nodiscard]] std::shared_ptr<MTP::SessionThreads> mtpThreads();
+
+	struct TransportStats {
+		int threads = 0;
+		int connections = 0;
+	};
+	[[nodiscard]] TransportStats transportStats() const;
+
 	// Interface for Storage::Domain.
 	void accountAddedInStorage(AccountWithIndex accountWithIndex);
 	void activateFromStorage(int index);
@@ -83,6 +103,9 @@ private:
 	void updateUnreadBadge();
 	void scheduleUpdateUnreadBadge();
 	void suggestExportIfNeeded();
+	void releaseSharedCacheBigFile(not_null<Account*> account);
+	void refreshSharedCacheBigFileSettings();
+	void clearSharedCacheBigFile();
 
 	const QString _dataName;
 	const std::unique_ptr<Storage::Domain> _local;
@@ -101,6 +124,14 @@ private:
 	bool _unreadBadgeMuted = true;
 	bool _unreadBadgeUpdateScheduled = false;
 
+	std::optional<Storage::DatabasePointer> _sharedBigFileCache;
+	base::flat_map<
+		not_null<Account*>,
+		Storage::Cache::Database::Settings> _sharedBigFileCacheUsers;
+	Storage::Cache::Database::SettingsUpdate _sharedBigFileCacheLimits;
+
+	std::shared_ptr<MTP::SessionThreads> _mtpThreads;
+
 	rpl::lifetime _activeLifetime;
 	rpl::lifetime _lifetime;
 
@@ -200,6 +200,12 @@ void Instance::unlockPlayer() {
 	}
 }
 
+bool Instance::playerUsedByOthers() const {
+	Expects(_shared != nullptr);
+
+	return (_shared->_instances.size() > 1);
+}
+
 bool Instance::playerLocked() const {
 	Expects(_shared != nullptr);
 
@@ -76,6 +76,9 @@ public:
 	void unlockPlayer();
 	[[nodiscard]] bool playerLocked() const;
 
+	// Whether other instances (inline, PiP, etc.) use the same player.
+	[[nodiscard]] bool playerUsedByOthers() const;
+
 	void setPriority(int priority);
 	[[nodiscard]] int priority() const;
 
@@ -847,9 +847,11 @@ Reader::SerializedSlice Reader::Slices::unloadToCache() {
 
 Reader::Reader(
 	std::unique_ptr<Loader> loader,
-	Storage::Cache::Database *cache)
+	Storage::Cache::Database *cache,
+	uint8 cacheTag)
 : _loader(std::move(loader))
 , _cache(cache)
+, _cacheTag(cacheTag)
 , _cacheHelper(cache ? InitCacheHelper(_loader->baseCacheKey()) : nullptr)
 , _slices(_loader->size(), _cacheHelper != nullptr) {
 	_loader->parts(
@@ -1188,7 +1190,11 @@ void Reader::putToCache(SerializedSlice &&slice) {
 	Expects(_cacheHelper != nullptr);
 	Expects(slice.number >= 0);
 
-	_cache->put(_cacheHelper->key(slice.number), std::move(slice.data));
+	_cache->put(
+		_cacheHelper->key(slice.number),
+		Storage::Cache::Database::TaggedValue(
+			std::move(slice.data),
+			_cacheTag));
 }
 
 int Reader::size() const {
@@ -42,7 +42,8 @@ public:
 	// Main thread.
 	explicit Reader(
 		std::unique_ptr<Loader> loader,
-		Storage::Cache::Database *cache = nullptr);
+		Storage::Cache::Database *cache = nullptr,
+		uint8 cacheTag = 0);
 
 	void setLoaderPriority(int priority);
 
@@ -236,6 +237,7 @@ private:
 
 	const std::unique_ptr<Loader> _loader;
 	Storage::Cache::Database * const _cache = nullptr;
+	const uint8 _cacheTag = 0;
 
 	// shared_ptr is used to be able to have weak_ptr.
 	const std::shared_ptr<CacheHelper> _cacheHelper;
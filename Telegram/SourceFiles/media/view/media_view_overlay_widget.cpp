@@ -92,6 +92,8 @@ namespace View {
 namespace {
 
 constexpr auto kPreloadCount = 3;
+constexpr auto kPreloadMaxCount = 8;
+constexpr auto kPreloadVideosCount = 2;
 constexpr auto kMaxZoomLevel = 7; // x8
 constexpr auto kZoomToScreenLevel = 1024;
 constexpr auto kOverlayLoaderPriority = 2;
@@ -107,6 +109,12 @@ constexpr auto kIdsLimit = 48;
 // Preload next messages if we went further from current than that.
 constexpr auto kIdsPreloadAfter = 28;
 
+// Moving faster than that preloads more than kPreloadCount items ahead.
+constexpr auto kBrowsingFastInterval = crl::time(800);
+
+// Pause after which the browsing pace is measured again.
+constexpr auto kBrowsingResetInterval = 3 * crl::time(1000);
+
 class PipDelegate final : public Pip::Delegate {
 public:
 	PipDelegate(QWidget *parent, not_null<Main::Session*> session);
@@ -231,6 +239,13 @@ struct OverlayWidget::Streamed {
 	bool resumeOnCallEnd = false;
 };
 
+struct OverlayWidget::VideoPreload {
+	VideoPreload(not_null<DocumentData*> document, Data::FileOrigin origin);
+
+	Streaming::Instance instance;
+	bool ready = false;
+};
+
 struct OverlayWidget::PipWrap {
 	PipWrap(
 		QWidget *parent,
@@ -247,6 +262,12 @@ struct OverlayWidget::PipWrap {
 	Pip wrapped;
 };
 
+OverlayWidget::VideoPreload::VideoPreload(
+	not_null<DocumentData*> document,
+	Data::FileOrigin origin)
+: instance(document, origin, nullptr) {
+}
+
 OverlayWidget::Streamed::Streamed(
 	not_null<DocumentData*> document,
 	Data::FileOrigin origin,
@@ -1942,7 +1963,7 @@ void OverlayWidget::handleSharedMediaUpdate(SharedMediaWithLastSlice &&update) {
 	}
 	findCurrent();
 	updateControls();
-	preloadData(0);
+	preloadData();
 }
 
 std::optional<OverlayWidget::UserPhotosKey> OverlayWidget::userPhotosKey() const {
@@ -2002,7 +2023,7 @@ void OverlayWidget::handleUserPhotosUpdate(UserPhotosSlice &&update) {
 	}
 	findCurrent();
 	updateControls();
-	preloadData(0);
+	preloadData();
 }
 
 std::optional<OverlayWidget::CollageKey> OverlayWidget::collageKey() const {
@@ -2276,7 +2297,7 @@ void OverlayWidget::show(OpenRequest request) {
 		assignMediaPointer(photo);
 
 		displayPhoto(photo);
-		preloadData(0);
+		preloadData();
 		activateControls();
 	} else if (document) {
 		setSession(&document->session());
@@ -2297,7 +2318,7 @@ void OverlayWidget::show(OpenRequest request) {
 				: Data::CloudTheme(),
 			request.continueStreaming());
 		if (!isHidden()) {
-			preloadData(0);
+			preloadData();
 			activateControls();
 		}
 	}
@@ -4028,11 +4049,71 @@ bool OverlayWidget::moveToNext(int delta) {
 	if (!_index) {
 		return false;
 	}
-	auto newIndex = *_index + delta;
-	return moveToEntity(entityByIndex(newIndex), delta);
+	const auto entity = entityByIndex(*_index + delta);
+	if (v::is_null(entity.data) && !entity.item) {
+		return false;
+	}
+	updateBrowsing(delta);
+	if (const auto ready = preloadedReady(entity)) {
+		++_preloadMoves;
+		if (*ready) {
+			++_preloadHits;
+		}
+	}
+	return moveToEntity(entity);
 }
 
-bool OverlayWidget::moveToEntity(const Entity &entity, int preloadDelta) {
+void OverlayWidget::updateBrowsing(int delta) {
+	const auto now = crl::now();
+	const auto direction = (delta > 0) ? 1 : (delta < 0) ? -1 : 0;
+	const auto interval = now - _browsingLastMove;
+	if (direction != _browsingDirection
+		|| interval >= kBrowsingResetInterval) {
+		_browsingInterval = 0;
+	} else if (!_browsingInterval) {
+		_browsingInterval = interval;
+	} else {
+		_browsingInterval = (_browsingInterval * 3 + interval) / 4;
+	}
+	_browsingDirection = direction;
+	_browsingLastMove = now;
+}
+
+int OverlayWidget::preloadAheadCount() const {
+	if (!_browsingDirection) {
+		return 1;
+	} else if (!_browsingInterval
+		|| _browsingInterval >= kBrowsingFastInterval) {
+		return kPreloadCount;
+	}
+	const auto count = kPreloadCount
+		* kBrowsingFastInterval
+		/ std::max(_browsingInterval, crl::time(1));
+	return std::clamp(int(count), kPreloadCount, kPreloadMaxCount);
+}
+
+std::optional<bool> OverlayWidget::preloadedReady(
+		const Entity &entity) const {
+	if (const auto photo = std::get_if<not_null<PhotoData*>>(
+			&entity.data)) {
+		const auto media = (*photo)->activeMediaView();
+		return media && media->loaded();
+	} else if (const auto document = std::get_if<not_null<DocumentData*>>(
+			&entity.data)) {
+		if (!(*document)->isVideoFile()) {
+			return std::nullopt;
+		}
+		const auto i = _preloadVideos.find(*document);
+		if (i != end(_preloadVideos)) {
+			return i->second->ready;
+		}
+		const auto media = (*document)->activeMediaView();
+		return media && media->loaded();
+	}
+	return std::nullopt;
+}
+
+bool OverlayWidget::moveToEntity(const Entity &entity) {
 	if (v::is_null(entity.data) && !entity.item) {
 		return false;
 	}
@@ -4052,26 +4133,39 @@ bool OverlayWidget::moveToEntity(const Entity &entity, int preloadDelta) {
 	} else {
 		displayDocument(nullptr);
 	}
-	preloadData(preloadDelta);
+	preloadData();
 	return true;
 }
 
-void OverlayWidget::preloadData(int delta) {
+void OverlayWidget::preloadData() {
 	if (!_index) {
 		return;
 	}
-	auto from = *_index + (delta ? -delta : -1);
-	auto till = *_index + (delta ? delta * kPreloadCount : 1);
-	if (from > till) std::swap(from, till);
+	const auto ahead = preloadAheadCount();
+	const auto forward = (_browsingDirection >= 0);
+	auto from = *_index - (forward ? 1 : ahead);
+	auto till = *_index + (forward ? ahead : 1);
 
 	auto photos = base::flat_set<std::shared_ptr<Data::PhotoMedia>>();
 	auto documents = base::flat_set<std::shared_ptr<Data::DocumentMedia>>();
+	auto videos = base::flat_map<
+		not_null<DocumentData*>,
+		std::unique_ptr<VideoPreload>>();
+	auto loading = base::flat_set<not_null<PhotoData*>>();
 	for (auto index = from; index != till + 1; ++index) {
 		auto entity = entityByIndex(index);
 		if (auto photo = std::get_if<not_null<PhotoData*>>(&entity.data)) {
 			const auto [i, ok] = photos.emplace((*photo)->createMediaView());
 			(*i)->wanted(Data::PhotoSize::Small, fileOrigin(entity));
+			const auto started = !(*photo)->loading() && !(*i)->loaded();
 			(*photo)->load(fileOrigin(entity), LoadFromCloudOrLocal, true);
+			if (index == *_index) {
+				// The viewer itself needs this one now.
+				_preloadLoadingPhotos.remove(*photo);
+			} else if ((started || _preloadLoadingPhotos.contains(*photo))
+				&& (*photo)->loading()) {
+				loading.emplace(*photo);
+			}
 		} else if (auto document = std::get_if<not_null<DocumentData*>>(
 				&entity.data)) {
 			const auto [i, ok] = documents.emplace(
@@ -4079,11 +4173,82 @@ void OverlayWidget::preloadData(int delta) {
 			(*i)->thumbnailWanted(fileOrigin(entity));
 			if (!(*i)->canBePlayed()) {
 				(*i)->automaticLoad(fileOrigin(entity), entity.item);
+			} else if (index != *_index
+				&& (*document)->isVideoFile()
+				&& !(*i)->loaded()
+				&& std::abs(index - *_index) <= kPreloadVideosCount
+				&& ((index > *_index) == forward)) {
+				const auto j = _preloadVideos.find(*document);
+				auto preload = (j != end(_preloadVideos))
+					? std::move(j->second)
+					: preloadVideo(*document, fileOrigin(entity));
+				if (preload) {
+					videos.emplace(*document, std::move(preload));
+				}
 			}
 		}
 	}
+	for (const auto photo : _preloadLoadingPhotos) {
+		if (!loading.contains(photo)) {
+			photo->stopLoading();
+		}
+	}
+	_preloadLoadingPhotos = std::move(loading);
 	_preloadPhotos = std::move(photos);
 	_preloadDocuments = std::move(documents);
+	_preloadVideos = std::move(videos);
+}
+
+auto OverlayWidget::preloadVideo(
+		not_null<DocumentData*> document,
+		Data::FileOrigin origin) -> std::unique_ptr<VideoPreload> {
+	auto result = std::make_unique<VideoPreload>(document, origin);
+	const auto raw = result.get();
+	if (!raw->instance.valid()) {
+		return nullptr;
+	}
+	const auto stop = [=] {
+		InvokeQueued(_widget, [=] {
+			const auto i = _preloadVideos.find(document);
+			// The player may be shared with PiP or inline autoplay.
+			if (i != end(_preloadVideos)
+				&& i->second.get() == raw
+				&& !raw->instance.playerUsedByOthers()) {
+				raw->instance.stop();
+			}
+		});
+	};
+	raw->instance.setPriority(kOverlayLoaderPriority);
+	raw->instance.player().updates(
+	) | rpl::start_with_next_error([=](Streaming::Update &&update) {
+		if (v::is<Streaming::Information>(update.data)) {
+			// The header and the first frame are in the shared reader now,
+			// the viewer will start from them when it gets to this video.
+			raw->ready = true;
+			stop();
+		}
+	}, [=](Streaming::Error &&error) {
+		stop();
+	}, raw->instance.lifetime());
+	if (!raw->instance.player().active()) {
+		auto options = Streaming::PlaybackOptions();
+		options.mode = Streaming::Mode::Video;
+		raw->instance.play(options);
+	}
+	return result;
+}
+
+void OverlayWidget::logPreloadStats() {
+	if (_preloadMoves) {
+		DEBUG_LOG(("Media Viewer Info: "
+			"preload hit rate %1% (%2 of %3 moves)."
+			).arg(_preloadHits * 100 / _preloadMoves
+			).arg(_preloadHits
+			).arg(_preloadMoves));
+	}
+	_preloadMoves = _preloadHits = 0;
+	_browsingDirection = 0;
+	_browsingLastMove = _browsingInterval = 0;
 }
 
 void OverlayWidget::handleMousePress(
@@ -4602,8 +4767,13 @@ void OverlayWidget::clearBeforeHide() {
 	_collage = nullptr;
 	_collageData = std::nullopt;
 	assignMediaPointer(nullptr);
+	for (const auto photo : base::take(_preloadLoadingPhotos)) {
+		photo->stopLoading();
+	}
 	_preloadPhotos.clear();
 	_preloadDocuments.clear();
+	_preloadVideos.clear();
+	logPreloadStats();
 	if (_menu) {
 		_menu->hideMenu(true);
 	}
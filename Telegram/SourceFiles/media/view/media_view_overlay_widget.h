@@ -105,6 +105,7 @@ public:
 private:
 	struct Streamed;
 	struct PipWrap;
+	struct VideoPreload;
 	class Renderer;
 	class RendererSW;
 	class RendererGL;
@@ -216,7 +217,15 @@ private:
 	void moveToScreen();
 	void updateGeometry();
 	bool moveToNext(int delta);
-	void preloadData(int delta);
+	void updateBrowsing(int delta);
+	[[nodiscard]] int preloadAheadCount() const;
+	[[nodiscard]] std::optional<bool> preloadedReady(
+		const Entity &entity) const;
+	void preloadData();
+	[[nodiscard]] std::unique_ptr<VideoPreload> preloadVideo(
+		not_null<DocumentData*> document,
+		Data::FileOrigin origin);
+	void logPreloadStats();
 
 	void handleScreenChanged(QScreen *screen);
 
@@ -228,7 +237,7 @@ private:
 	Entity entityForCollage(int index) const;
 	Entity entityByIndex(int index) const;
 	Entity entityForItemId(const FullMsgId &itemId) const;
-	bool moveToEntity(const Entity &entity, int preloadDelta = 0);
+	bool moveToEntity(const Entity &entity);
 	void setContext(std::variant<
 		v::null_t,
 		not_null<HistoryItem*>,
@@ -425,6 +434,18 @@ private:
 	std::shared_ptr<Data::DocumentMedia> _documentMedia;
 	base::flat_set<std::shared_ptr<Data::PhotoMedia>> _preloadPhotos;
 	base::flat_set<std::shared_ptr<Data::DocumentMedia>> _preloadDocuments;
+	base::flat_map<
+		not_null<DocumentData*>,
+		std::unique_ptr<VideoPreload>> _preloadVideos;
+	// Full size loads started by the preloader, stopped out of its range.
+	base::flat_set<not_null<PhotoData*>> _preloadLoadingPhotos;
+
+	// Direction and pace of the arrow / swipe browsing, to preload ahead.
+	int _browsingDirection = 0;
+	crl::time _browsingLastMove = 0;
+	crl::time _browsingInterval = 0;
+	int _preloadMoves = 0;
+	int _preloadHits = 0;
 	int _rotation = 0;
 	std::unique_ptr<SharedMedia> _sharedMedia;
 	std::optional<SharedMediaWithLastSlice> _sharedMediaData;
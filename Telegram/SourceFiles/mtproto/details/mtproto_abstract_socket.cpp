@@ -10,7 +10,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/details/mtproto_tcp_socket.h"
 #include "mtproto/details/mtproto_tls_socket.h"
 
+#include <QtNetwork/QHostAddress>
+
 namespace MTP::details {
+namespace {
+
+constexpr auto kMeasurePeriod = crl::time(1000);
+
+} // namespace
 
 std::unique_ptr<AbstractSocket> AbstractSocket::Create(
 		not_null<QThread*> thread,
@@ -28,4 +35,75 @@ std::unique_ptr<AbstractSocket> AbstractSocket::Create(
 	}
 }
 
+void AbstractSocket::setupSocketOptions(
+		not_null<QAbstractSocket*> socket,
+		bool protocolForFiles) {
+	_optionsSocket = socket;
+	_protocolForFiles = protocolForFiles;
+
+	// Directly on the socket thread, so that the RTT doesn't include
+	// the time the queued connected() handlers wait in the event loop.
+	connect(socket, &QAbstractSocket::connected, [=] {
+		socketConnected();
+	});
+}
+
+void AbstractSocket::socketConnecting(const QString &address) {
+	Expects(_optionsSocket != nullptr);
+
+	_connectingStarted = crl::now();
+
+	// Qt applies the options only to an existing socket engine.
+	// Without a proxy bind() creates it, so the options are in place
+	// before the SYN is sent, otherwise they're set after connecting.
+	const auto host = QHostAddress(address);
+	const auto any = (host.protocol() == QAbstractSocket::IPv6Protocol)
+		? QHostAddress::AnyIPv6
+		: QHostAddress::AnyIPv4;
+	_optionsApplied = !host.isNull()
+		&& (_optionsSocket->proxy().type() == QNetworkProxy::NoProxy)
+		&& _optionsSocket->bind(QHostAddress(any));
+	if (_optionsApplied) {
+		applySocketOptions();
+	}
+}
+
+void AbstractSocket::socketConnected() {
+	const auto now = crl::now();
+	if (_connectingStarted) {
+		_metrics.rtt = now - base::take(_connectingStarted);
+	}
+	_measureStarted = now;
+	_measureReceived = 0;
+	if (!base::take(_optionsApplied)) {
+		applySocketOptions();
+	}
+}
+
+void AbstractSocket::socketReceived(int64 size) {
+	if (size <= 0) {
+		return;
+	}
+	_metrics.received += size;
+	_measureReceived += size;
+
+	const auto now = crl::now();
+	const auto passed = now - _measureStarted;
+	if (!_measureStarted || passed < kMeasurePeriod) {
+		return;
+	}
+	_metrics.receivedPerSecond = _measureReceived * 1000 / passed;
+	_measureStarted = now;
+	_measureReceived = 0;
+}
+
+void AbstractSocket::applySocketOptions() {
+	_optionsSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+	if (_protocolForFiles) {
+		_optionsSocket->setSocketOption(
+			QAbstractSocket::SendBufferSizeSocketOption,
+			kFilesSendBufferSize);
+	}
+}
+
 } // namespace MTP::details
@@ -10,6 +10,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/bytes.h"
 #include "base/basic_types.h"
 
+class QAbstractSocket;
+
 namespace MTP::details {
 
 class AbstractSocket : protected QObject {
@@ -53,9 +55,27 @@ public:
 
 	virtual int32 debugState() = 0;
 
+	struct Metrics {
+		crl::time rtt = 0; // Measured by the TCP handshake.
+		int64 received = 0;
+		int64 receivedPerSecond = 0;
+	};
+
+	// Socket thread only, like the socket itself.
+	[[nodiscard]] const Metrics &metrics() const {
+		return _metrics;
+	}
+
 protected:
 	static const int kFilesSendBufferSize = 2 * 1024 * 1024;
-	static const int kFilesReceiveBufferSize = 2 * 1024 * 1024;
+
+	// Disables Nagle's algorithm and, for file connections, enlarges
+	// the send buffer. The receive buffer is left to the OS autotuning.
+	void setupSocketOptions(
+		not_null<QAbstractSocket*> socket,
+		bool protocolForFiles);
+	void socketConnecting(const QString &address);
+	void socketReceived(int64 size);
 
 	rpl::event_stream<> _connected;
 	rpl::event_stream<> _disconnected;
@@ -63,6 +83,18 @@ protected:
 	rpl::event_stream<> _error;
 	rpl::event_stream<> _syncTimeRequests;
 
+private:
+	void socketConnected();
+	void applySocketOptions();
+
+	QAbstractSocket *_optionsSocket = nullptr;
+	bool _protocolForFiles = false;
+	bool _optionsApplied = false;
+	crl::time _connectingStarted = 0;
+	crl::time _measureStarted = 0;
+	int64 _measureReceived = 0;
+	Metrics _metrics;
+
 };
 
 } // namespace MTP::details
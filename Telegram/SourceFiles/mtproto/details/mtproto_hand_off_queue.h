@@ -0,0 +1,75 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <atomic>
+
+namespace MTP::details {
+
+// Passes values from any number of producer threads to one consumer
+// thread without locks. push() is a single compare-exchange and
+// takeAll() grabs everything pushed so far with a single exchange.
+//
+// push() reports if the queue was empty, so the producer wakes the
+// consumer once per batch instead of once per value.
+template <typename Value>
+class HandOffQueue final {
+public:
+	HandOffQueue() = default;
+	HandOffQueue(const HandOffQueue &other) = delete;
+	HandOffQueue &operator=(const HandOffQueue &other) = delete;
+	~HandOffQueue() {
+		Destroy(_head.exchange(nullptr, std::memory_order_acquire));
+	}
+
+	// Returns true if the consumer should be woken up.
+	bool push(Value &&value) {
+		const auto node = new Node{ std::move(value) };
+		node->next = _head.load(std::memory_order_relaxed);
+		while (!_head.compare_exchange_weak(
+				node->next,
+				node,
+				std::memory_order_release,
+				std::memory_order_relaxed)) {
+		}
+		return (node->next == nullptr);
+	}
+
+	// Returns values in the order they were pushed.
+	[[nodiscard]] std::vector<Value> takeAll() {
+		auto node = _head.exchange(nullptr, std::memory_order_acquire);
+		auto result = std::vector<Value>();
+		while (node) {
+			result.push_back(std::move(node->value));
+			delete std::exchange(node, node->next);
+		}
+		std::reverse(begin(result), end(result));
+		return result;
+	}
+
+	[[nodiscard]] bool empty() const {
+		return (_head.load(std::memory_order_acquire) == nullptr);
+	}
+
+private:
+	struct Node {
+		Value value;
+		Node *next = nullptr;
+	};
+
+	static void Destroy(Node *node) {
+		while (node) {
+			delete std::exchange(node, node->next);
+		}
+	}
+
+	std::atomic<Node*> _head = nullptr;
+
+};
+
+} // namespace MTP::details
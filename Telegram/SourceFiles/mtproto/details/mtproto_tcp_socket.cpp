@@ -19,14 +19,7 @@ TcpSocket::TcpSocket(
 : AbstractSocket(thread) {
 	_socket.moveToThread(thread);
 	_socket.setProxy(proxy);
-	if (protocolForFiles) {
-		_socket.setSocketOption(
-			QAbstractSocket::SendBufferSizeSocketOption,
-			kFilesSendBufferSize);
-		_socket.setSocketOption(
-			QAbstractSocket::ReceiveBufferSizeSocketOption,
-			kFilesReceiveBufferSize);
-	}
+	setupSocketOptions(&_socket, protocolForFiles);
 	const auto wrap = [&](auto handler) {
 		return [=](auto &&...args) {
 			InvokeQueued(this, [=] { handler(args...); });
@@ -52,6 +45,7 @@ TcpSocket::TcpSocket(
 }
 
 void TcpSocket::connectToHost(const QString &address, int port) {
+	socketConnecting(address);
 	_socket.connectToHost(address, port);
 }
 
@@ -92,9 +86,11 @@ bool TcpSocket::hasBytesAvailable() {
 }
 
 int64 TcpSocket::read(bytes::span buffer) {
-	return _socket.read(
+	const auto result = _socket.read(
 		reinterpret_cast<char*>(buffer.data()),
 		buffer.size());
+	socketReceived(result);
+	return result;
 }
 
 void TcpSocket::write(bytes::const_span prefix, bytes::const_span buffer) {
@@ -454,14 +454,7 @@ TlsSocket::TlsSocket(
 
 	_socket.moveToThread(thread);
 	_socket.setProxy(proxy);
-	if (protocolForFiles) {
-		_socket.setSocketOption(
-			QAbstractSocket::SendBufferSizeSocketOption,
-			kFilesSendBufferSize);
-		_socket.setSocketOption(
-			QAbstractSocket::ReceiveBufferSizeSocketOption,
-			kFilesReceiveBufferSize);
-	}
+	setupSocketOptions(&_socket, protocolForFiles);
 	const auto wrap = [&](auto handler) {
 		return [=](auto &&...args) {
 			InvokeQueued(this, [=] { handler(args...); });
@@ -632,7 +625,9 @@ void TlsSocket::readData() {
 	if (!isConnected()) {
 		return;
 	}
+	const auto was = _incoming.size();
 	_incoming.append(_socket.readAll());
+	socketReceived(_incoming.size() - was);
 	if (!checkNextPacket()) {
 		handleError();
 	} else if (hasBytesAvailable()) {
@@ -685,6 +680,7 @@ void TlsSocket::connectToHost(const QString &address, int port) {
 	Expects(_state == State::NotConnected);
 
 	_state = State::Connecting;
+	socketConnecting(address);
 	_socket.connectToHost(address, port);
 }
 
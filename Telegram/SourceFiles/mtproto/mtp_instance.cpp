@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/details/mtproto_rsa_public_key.h"
 #include "mtproto/special_config_request.h"
 #include "mtproto/session.h"
+#include "mtproto/session_threads.h"
 #include "mtproto/mtproto_config.h"
 #include "mtproto/mtproto_dc_options.h"
 #include "mtproto/config_loader.h"
@@ -38,6 +39,214 @@ using namespace details;
 
 std::atomic<int> GlobalAtomicRequestId = 0;
 
+// Everything known about in-flight requests, kept in one record per
+// request. Records are sharded by request id, so the session threads
+// answering requests and the main thread sending them rarely wait for
+// each other. Ids grow monotonically, so insertions go to the end of
+// each shard's flat map.
+class RequestRegistry final {
+public:
+	void store(
+		mtpRequestId requestId,
+		const SerializedRequest &request,
+		ResponseHandler &&callbacks);
+	void setDc(mtpRequestId requestId, ShiftedDcId shiftedDcId);
+	[[nodiscard]] std::optional<ShiftedDcId> dc(
+		mtpRequestId requestId) const;
+	std::optional<ShiftedDcId> changeDc(
+		mtpRequestId requestId,
+		DcId newdc);
+
+	[[nodiscard]] SerializedRequest request(mtpRequestId requestId) const;
+	[[nodiscard]] bool hasHandler(mtpRequestId requestId) const;
+	[[nodiscard]] ResponseHandler takeHandler(mtpRequestId requestId);
+	void restoreHandler(mtpRequestId requestId, ResponseHandler &&handler);
+
+	// Doubles the resend delay on every call, returns seconds.
+	[[nodiscard]] int nextResendDelay(mtpRequestId requestId);
+
+	// Forgets the request body, dc and resend delay, keeps the handler.
+	void unregister(mtpRequestId requestId);
+
+	// Forgets everything, returns msg_id the request was sent with.
+	mtpMsgId cancel(mtpRequestId requestId);
+
+private:
+	struct Entry {
+		SerializedRequest request;
+		ResponseHandler handler;
+
+		// dcWithShift for request to this dc or -dc for request to main dc.
+		std::optional<ShiftedDcId> shiftedDcId;
+
+		int resendDelay = 0;
+	};
+	struct Shard {
+		mutable QMutex mutex;
+		base::flat_map<mtpRequestId, Entry> entries;
+	};
+	using Iterator = base::flat_map<mtpRequestId, Entry>::iterator;
+
+	static constexpr auto kShardsCount = 16;
+
+	[[nodiscard]] Shard &shard(mtpRequestId requestId);
+	[[nodiscard]] const Shard &shard(mtpRequestId requestId) const;
+	static void EraseIfEmpty(Shard &shard, Iterator i);
+
+	std::array<Shard, kShardsCount> _shards;
+
+};
+
+auto RequestRegistry::shard(mtpRequestId requestId) -> Shard & {
+	return _shards[uint32(requestId) % kShardsCount];
+}
+
+auto RequestRegistry::shard(mtpRequestId requestId) const -> const Shard & {
+	return _shards[uint32(requestId) % kShardsCount];
+}
+
+void RequestRegistry::EraseIfEmpty(Shard &shard, Iterator i) {
+	const auto &entry = i->second;
+	if (!entry.request
+		&& !entry.handler.done
+		&& !entry.handler.fail
+		&& !entry.shiftedDcId) {
+		shard.entries.erase(i);
+	}
+}
+
+void RequestRegistry::store(
+		mtpRequestId requestId,
+		const SerializedRequest &request,
+		ResponseHandler &&callbacks) {
+	auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	auto &entry = shard.entries[requestId];
+	if (!entry.handler.done && !entry.handler.fail) {
+		entry.handler = std::move(callbacks);
+	}
+	if (!entry.request) {
+		entry.request = request;
+	}
+}
+
+void RequestRegistry::setDc(
+		mtpRequestId requestId,
+		ShiftedDcId shiftedDcId) {
+	auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	shard.entries[requestId].shiftedDcId = shiftedDcId;
+}
+
+std::optional<ShiftedDcId> RequestRegistry::dc(
+		mtpRequestId requestId) const {
+	const auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	const auto i = shard.entries.find(requestId);
+	return (i != end(shard.entries)) ? i->second.shiftedDcId : std::nullopt;
+}
+
+std::optional<ShiftedDcId> RequestRegistry::changeDc(
+		mtpRequestId requestId,
+		DcId newdc) {
+	auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	const auto i = shard.entries.find(requestId);
+	if (i == end(shard.entries) || !i->second.shiftedDcId) {
+		return std::nullopt;
+	}
+	auto &shiftedDcId = *i->second.shiftedDcId;
+	if (shiftedDcId < 0) {
+		shiftedDcId = -newdc;
+	} else {
+		shiftedDcId = ShiftDcId(newdc, GetDcIdShift(shiftedDcId));
+	}
+	return shiftedDcId;
+}
+
+SerializedRequest RequestRegistry::request(mtpRequestId requestId) const {
+	const auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	const auto i = shard.entries.find(requestId);
+	return (i != end(shard.entries))
+		? i->second.request
+		: SerializedRequest();
+}
+
+bool RequestRegistry::hasHandler(mtpRequestId requestId) const {
+	const auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	const auto i = shard.entries.find(requestId);
+	return (i != end(shard.entries))
+		&& (i->second.handler.done || i->second.handler.fail);
+}
+
+ResponseHandler RequestRegistry::takeHandler(mtpRequestId requestId) {
+	auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	const auto i = shard.entries.find(requestId);
+	if (i == end(shard.entries)) {
+		return ResponseHandler();
+	}
+	auto result = base::take(i->second.handler);
+	EraseIfEmpty(shard, i);
+	return result;
+}
+
+void RequestRegistry::restoreHandler(
+		mtpRequestId requestId,
+		ResponseHandler &&handler) {
+	auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	auto &entry = shard.entries[requestId];
+	if (!entry.handler.done && !entry.handler.fail) {
+		entry.handler = std::move(handler);
+	}
+}
+
+int RequestRegistry::nextResendDelay(mtpRequestId requestId) {
+	auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	const auto i = shard.entries.find(requestId);
+	if (i == end(shard.entries)) {
+		return 1;
+	}
+	auto &delay = i->second.resendDelay;
+	if (!delay) {
+		return (delay = 1);
+	}
+	return (delay > 60) ? delay : (delay *= 2);
+}
+
+void RequestRegistry::unregister(mtpRequestId requestId) {
+	auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	const auto i = shard.entries.find(requestId);
+	if (i == end(shard.entries)) {
+		return;
+	}
+	auto &entry = i->second;
+	entry.request = SerializedRequest();
+	entry.shiftedDcId = std::nullopt;
+	entry.resendDelay = 0;
+	EraseIfEmpty(shard, i);
+}
+
+mtpMsgId RequestRegistry::cancel(mtpRequestId requestId) {
+	auto &shard = this->shard(requestId);
+	QMutexLocker locker(&shard.mutex);
+	const auto i = shard.entries.find(requestId);
+	if (i == end(shard.entries)) {
+		return 0;
+	}
+	const auto &request = i->second.request;
+	const auto result = request
+		? *(mtpMsgId*)(request->constData() + 4)
+		: mtpMsgId(0);
+	shard.entries.erase(i);
+	return result;
+}
+
 } // namespace
 
 namespace details {
@@ -99,10 +308,13 @@ public:
 	void restartedByTimeout(ShiftedDcId shiftedDcId);
 	[[nodiscard]] rpl::producer<ShiftedDcId> restartsByTimeout() const;
 
+	[[nodiscard]] crl::time batchWindow(RequestPriority priority) const;
+
 	void restart();
 	void restart(ShiftedDcId shiftedDcId);
 	[[nodiscard]] int32 dcstate(ShiftedDcId shiftedDcId = 0);
 	[[nodiscard]] QString dctransport(ShiftedDcId shiftedDcId = 0);
+	[[nodiscard]] int connectedSessionsCount() const;
 	void ping();
 	void cancel(mtpRequestId requestId);
 	[[nodiscard]] int32 state(mtpRequestId requestId); // < 0 means waiting for such count of ms
@@ -194,7 +406,6 @@ private:
 	Session *findSession(ShiftedDcId shiftedDcId);
 	not_null<Session*> startSession(ShiftedDcId shiftedDcId);
 	void scheduleSessionDestroy(ShiftedDcId shiftedDcId);
-	[[nodiscard]] not_null<QThread*> getThreadForDc(ShiftedDcId shiftedDcId);
 
 	void applyDomainIps(
 		const QString &host,
@@ -220,9 +431,7 @@ private:
 	const std::unique_ptr<Config> _config;
 	const std::shared_ptr<base::NetworkReachability> _networkReachability;
 
-	std::unique_ptr<QThread> _mainSessionThread;
-	std::unique_ptr<QThread> _otherSessionsThread;
-	std::vector<std::unique_ptr<QThread>> _fileSessionThreads;
+	const std::shared_ptr<SessionThreads> _threads;
 
 	QString _deviceModel;
 	QString _systemVersion;
@@ -252,25 +461,15 @@ private:
 	rpl::event_stream<> _writeKeysRequests;
 	rpl::event_stream<> _allKeysDestroyed;
 
-	// holds dcWithShift for request to this dc or -dc for request to main dc
-	std::map<mtpRequestId, ShiftedDcId> _requestsByDc;
-	mutable QMutex _requestByDcLock;
-
 	// holds target dcWithShift for auth export request
 	std::map<mtpRequestId, ShiftedDcId> _authExportRequests;
 
-	std::map<mtpRequestId, ResponseHandler> _parserMap;
-	mutable QMutex _parserMapLock;
-
-	std::map<mtpRequestId, SerializedRequest> _requestMap;
-	QReadWriteLock _requestMapLock;
+	RequestRegistry _requests;
 
 	std::deque<std::pair<mtpRequestId, crl::time>> _delayedRequests;
 	base::flat_map<mtpRequestId, mtpRequestId> _dependentRequests;
 	mutable QMutex _dependentRequestsLock;
 
-	std::map<mtpRequestId, int> _requestsDelays;
-
 	std::set<mtpRequestId> _badGuestDcRequests;
 
 	std::map<DcId, std::vector<mtpRequestId>> _authWaiters;
@@ -284,6 +483,8 @@ private:
 
 	Core::SettingsProxy &_proxySettings;
 
+	base::flat_map<RequestPriority, crl::time> _batchWindows;
+
 	rpl::lifetime _lifetime;
 
 };
@@ -305,12 +506,12 @@ Instance::Private::Private(
 , _mode(mode)
 , _config(std::move(fields.config))
 , _networkReachability(base::NetworkReachability::Instance())
+, _threads(fields.threads
+	? std::move(fields.threads)
+	: std::make_shared<SessionThreads>())
 , _proxySettings(Core::App().settings().proxy()) {
 	Expects(_config != nullptr);
 
-	const auto idealThreadPoolSize = QThread::idealThreadCount();
-	_fileSessionThreads.resize(2 * std::max(idealThreadPoolSize / 2, 1));
-
 	details::unpaused(
 	) | rpl::start_with_next([=] {
 		unpaused();
@@ -324,6 +525,9 @@ Instance::Private::Private(
 	_deviceModel = std::move(fields.deviceModel);
 	_systemVersion = std::move(fields.systemVersion);
 
+	_batchWindows = std::move(fields.batchWindows);
+	_batchWindows.remove(RequestPriority::Interactive);
+
 	for (auto &key : fields.keys) {
 		auto dcId = key->dcId();
 		auto shiftedDcId = dcId;
@@ -624,6 +828,12 @@ QString Instance::Private::dctransport(ShiftedDcId shiftedDcId) {
 	return QString();
 }
 
+int Instance::Private::connectedSessionsCount() const {
+	return ranges::count_if(_sessions, [](const auto &pair) {
+		return (pair.second->getState() == ConnectedState);
+	});
+}
+
 void Instance::Private::ping() {
 	getSession(0)->ping();
 }
@@ -633,23 +843,12 @@ void Instance::Private::cancel(mtpRequestId requestId) {
 
 	DEBUG_LOG(("MTP Info: Cancel request %1.").arg(requestId));
 	const auto shiftedDcId = queryRequestByDc(requestId);
-	auto msgId = mtpMsgId(0);
-	{
-		QWriteLocker locker(&_requestMapLock);
-		auto it = _requestMap.find(requestId);
-		if (it != _requestMap.end()) {
-			msgId = *(mtpMsgId*)(it->second->constData() + 4);
-			_requestMap.erase(it);
-		}
-	}
+	const auto msgId = _requests.cancel(requestId);
 	unregisterRequest(requestId);
 	if (shiftedDcId) {
 		const auto session = getSession(qAbs(*shiftedDcId));
 		session->cancel(requestId, msgId);
 	}
-
-	QMutexLocker locker(&_parserMapLock);
-	_parserMap.erase(requestId);
 }
 
 // result < 0 means waiting for such count of ms.
@@ -920,28 +1119,13 @@ bool Instance::Private::configLoadFail(const Error &error) {
 
 std::optional<ShiftedDcId> Instance::Private::queryRequestByDc(
 		mtpRequestId requestId) const {
-	QMutexLocker locker(&_requestByDcLock);
-	auto it = _requestsByDc.find(requestId);
-	if (it != _requestsByDc.cend()) {
-		return it->second;
-	}
-	return std::nullopt;
+	return _requests.dc(requestId);
 }
 
 std::optional<ShiftedDcId> Instance::Private::changeRequestByDc(
 		mtpRequestId requestId,
 		DcId newdc) {
-	QMutexLocker locker(&_requestByDcLock);
-	auto it = _requestsByDc.find(requestId);
-	if (it != _requestsByDc.cend()) {
-		if (it->second < 0) {
-			it->second = -newdc;
-		} else {
-			it->second = ShiftDcId(newdc, GetDcIdShift(it->second));
-		}
-		return it->second;
-	}
-	return std::nullopt;
+	return _requests.changeDc(requestId, newdc);
 }
 
 void Instance::Private::checkDelayedRequests() {
@@ -958,15 +1142,10 @@ void Instance::Private::checkDelayedRequests() {
 			continue;
 		}
 
-		auto request = SerializedRequest();
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
-				continue;
-			}
-			request = it->second;
+		const auto request = getRequest(requestId);
+		if (!request) {
+			DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
+			continue;
 		}
 		const auto session = getSession(qAbs(dcWithShift));
 		session->sendPrepared(request);
@@ -1007,23 +1186,13 @@ void Instance::Private::sendRequest(
 void Instance::Private::registerRequest(
 		mtpRequestId requestId,
 		ShiftedDcId shiftedDcId) {
-	QMutexLocker locker(&_requestByDcLock);
-	_requestsByDc[requestId] = shiftedDcId;
+	_requests.setDc(requestId, shiftedDcId);
 }
 
 void Instance::Private::unregisterRequest(mtpRequestId requestId) {
 	DEBUG_LOG(("MTP Info: unregistering request %1.").arg(requestId));
 
-	_requestsDelays.erase(requestId);
-
-	{
-		QWriteLocker locker(&_requestMapLock);
-		_requestMap.erase(requestId);
-	}
-	{
-		QMutexLocker locker(&_requestByDcLock);
-		_requestsByDc.erase(requestId);
-	}
+	_requests.unregister(requestId);
 	{
 		auto toRemove = base::flat_set<mtpRequestId>();
 		auto toResend = base::flat_set<mtpRequestId>();
@@ -1050,15 +1219,10 @@ void Instance::Private::unregisterRequest(mtpRequestId requestId) {
 
 		for (const auto resendingId : toResend) {
 			if (const auto shiftedDcId = queryRequestByDc(resendingId)) {
-				SerializedRequest request;
-				{
-					QReadLocker locker(&_requestMapLock);
-					auto it = _requestMap.find(resendingId);
-					if (it == _requestMap.cend()) {
-						LOG(("MTP Error: could not find dependent request %1").arg(resendingId));
-						return;
-					}
-					request = it->second;
+				const auto request = getRequest(resendingId);
+				if (!request) {
+					LOG(("MTP Error: could not find dependent request %1").arg(resendingId));
+					return;
 				}
 				getSession(qAbs(*shiftedDcId))->sendPrepared(request);
 			}
@@ -1070,48 +1234,23 @@ void Instance::Private::storeRequest(
 		mtpRequestId requestId,
 		const SerializedRequest &request,
 		ResponseHandler &&callbacks) {
-	if (callbacks.done || callbacks.fail) {
-		QMutexLocker locker(&_parserMapLock);
-		_parserMap.emplace(requestId, std::move(callbacks));
-	}
-	{
-		QWriteLocker locker(&_requestMapLock);
-		_requestMap.emplace(requestId, request);
-	}
+	_requests.store(requestId, request, std::move(callbacks));
 }
 
 SerializedRequest Instance::Private::getRequest(mtpRequestId requestId) {
-	auto result = SerializedRequest();
-	{
-		QReadLocker locker(&_requestMapLock);
-		auto it = _requestMap.find(requestId);
-		if (it != _requestMap.cend()) {
-			result = it->second;
-		}
-	}
-	return result;
+	return _requests.request(requestId);
 }
 
 bool Instance::Private::hasCallback(mtpRequestId requestId) const {
-	QMutexLocker locker(&_parserMapLock);
-	auto it = _parserMap.find(requestId);
-	return (it != _parserMap.cend());
+	return _requests.hasHandler(requestId);
 }
 
 void Instance::Private::processCallback(const Response &response) {
 	const auto requestId = response.requestId;
-	ResponseHandler handler;
-	{
-		QMutexLocker locker(&_parserMapLock);
-		auto it = _parserMap.find(requestId);
-		if (it != _parserMap.cend()) {
-			handler = std::move(it->second);
-			_parserMap.erase(it);
-
-			DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
-		}
-	}
+	auto handler = _requests.takeHandler(requestId);
 	if (handler.done || handler.fail) {
+		DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
+
 		const auto handleError = [&](const Error &error) {
 			DEBUG_LOG(("RPC Info: "
 				"error received, code %1, type %2, description: %3").arg(
@@ -1121,8 +1260,7 @@ void Instance::Private::processCallback(const Response &response) {
 			if (rpcErrorOccured(response, handler, error)) {
 				unregisterRequest(requestId);
 			} else {
-				QMutexLocker locker(&_parserMapLock);
-				_parserMap.emplace(requestId, std::move(handler));
+				_requests.restoreHandler(requestId, std::move(handler));
 			}
 		};
 
@@ -1223,10 +1361,9 @@ void Instance::Private::importDone(
 
 	auto &waiters = _authWaiters[newdc];
 	if (waiters.size()) {
-		QReadLocker locker(&_requestMapLock);
 		for (auto waitedRequestId : waiters) {
-			auto it = _requestMap.find(waitedRequestId);
-			if (it == _requestMap.cend()) {
+			const auto request = getRequest(waitedRequestId);
+			if (!request) {
 				LOG(("MTP Error: could not find request %1 for resending").arg(waitedRequestId));
 				continue;
 			}
@@ -1239,7 +1376,7 @@ void Instance::Private::importDone(
 			}
 			DEBUG_LOG(("MTP Info: resending request %1 to dc %2 after import auth").arg(waitedRequestId).arg(*shiftedDcId));
 			const auto session = getSession(*shiftedDcId);
-			session->sendPrepared(it->second);
+			session->sendPrepared(request);
 		}
 		waiters.clear();
 	}
@@ -1374,15 +1511,10 @@ bool Instance::Private::onErrorDefault(
 			newdcWithShift = ShiftDcId(newdcWithShift, GetDcIdShift(dcWithShift));
 		}
 
-		auto request = SerializedRequest();
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		const auto request = getRequest(requestId);
+		if (!request) {
+			LOG(("MTP Error: could not find request %1").arg(requestId));
+			return false;
 		}
 		const auto session = getSession(newdcWithShift);
 		registerRequest(
@@ -1391,15 +1523,10 @@ bool Instance::Private::onErrorDefault(
 		session->sendPrepared(request);
 		return true;
 	} else if (type == qstr("MSG_WAIT_TIMEOUT") || type == qstr("MSG_WAIT_FAILED")) {
-		SerializedRequest request;
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find MSG_WAIT_* request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		const auto request = getRequest(requestId);
+		if (!request) {
+			LOG(("MTP Error: could not find MSG_WAIT_* request %1").arg(requestId));
+			return false;
 		}
 		if (!request->after) {
 			LOG(("MTP Error: MSG_WAIT_* for not dependent request %1").arg(requestId));
@@ -1438,12 +1565,7 @@ bool Instance::Private::onErrorDefault(
 
 		int32 secs = 1;
 		if (code < 0 || code >= 500) {
-			auto it = _requestsDelays.find(requestId);
-			if (it != _requestsDelays.cend()) {
-				secs = (it->second > 60) ? it->second : (it->second *= 2);
-			} else {
-				_requestsDelays.emplace(requestId, secs);
-			}
+			secs = _requests.nextResendDelay(requestId);
 		} else if (m1.hasMatch()) {
 			secs = m1.captured(1).toInt();
 //			if (secs >= 60) return false;
@@ -1501,15 +1623,10 @@ bool Instance::Private::onErrorDefault(
 		return true;
 	} else if (type == qstr("CONNECTION_NOT_INITED")
 		|| type == qstr("CONNECTION_LAYER_INVALID")) {
-		SerializedRequest request;
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		const auto request = getRequest(requestId);
+		if (!request) {
+			LOG(("MTP Error: could not find request %1").arg(requestId));
+			return false;
 		}
 		auto dcWithShift = ShiftedDcId(0);
 		if (const auto shiftedDcId = queryRequestByDc(requestId)) {
@@ -1546,6 +1663,11 @@ not_null<Session*> Instance::Private::getSession(
 	return startSession(shiftedDcId);
 }
 
+crl::time Instance::Private::batchWindow(RequestPriority priority) const {
+	const auto i = _batchWindows.find(priority);
+	return (i != end(_batchWindows)) ? i->second : 0;
+}
+
 rpl::lifetime &Instance::Private::lifetime() {
 	return _lifetime;
 }
@@ -1559,7 +1681,7 @@ not_null<Session*> Instance::Private::startSession(ShiftedDcId shiftedDcId) {
 	Expects(BareDcId(shiftedDcId) != 0);
 
 	const auto dc = getDcById(shiftedDcId);
-	const auto thread = getThreadForDc(shiftedDcId);
+	const auto thread = _threads->forDc(shiftedDcId);
 	const auto result = _sessions.emplace(
 		shiftedDcId,
 		std::make_unique<Session>(_instance, thread, shiftedDcId, dc)
@@ -1585,56 +1707,6 @@ void Instance::Private::scheduleSessionDestroy(ShiftedDcId shiftedDcId) {
 }
 
 
-not_null<QThread*> Instance::Private::getThreadForDc(
-		ShiftedDcId shiftedDcId) {
-	static const auto EnsureStarted = [](
-			std::unique_ptr<QThread> &thread,
-			auto name) {
-		if (!thread) {
-			thread = std::make_unique<QThread>();
-			thread->setObjectName(name());
-			thread->start();
-		}
-		return thread.get();
-	};
-	static const auto FindOne = [](
-			std::vector<std::unique_ptr<QThread>> &threads,
-			const char *prefix,
-			int index,
-			bool shift) {
-		Expects(!threads.empty());
-		Expects(!(threads.size() % 2));
-
-		const auto count = int(threads.size());
-		index %= count;
-		if (index >= count / 2) {
-			index = (count - 1) - (index - count / 2);
-		}
-		if (shift) {
-			index = (index + count / 2) % count;
-		}
-		return EnsureStarted(threads[index], [=] {
-			return QString("MTP %1 Session (%2)").arg(prefix).arg(index);
-		});
-	};
-	if (shiftedDcId == BareDcId(shiftedDcId)) {
-		return EnsureStarted(_mainSessionThread, [] {
-			return QString("MTP Main Session");
-		});
-	} else if (isDownloadDcId(shiftedDcId)) {
-		const auto index = GetDcIdShift(shiftedDcId) - kBaseDownloadDcShift;
-		const auto composed = index + BareDcId(shiftedDcId);
-		return FindOne(_fileSessionThreads, "Download", composed, false);
-	} else if (isUploadDcId(shiftedDcId)) {
-		const auto index = GetDcIdShift(shiftedDcId) - kBaseUploadDcShift;
-		const auto composed = index + BareDcId(shiftedDcId);
-		return FindOne(_fileSessionThreads, "Upload", composed, true);
-	}
-	return EnsureStarted(_otherSessionsThread, [] {
-		return QString("MTP Other Session");
-	});
-}
-
 void Instance::Private::scheduleKeyDestroy(ShiftedDcId shiftedDcId) {
 	Expects(isKeysDestroyer());
 
@@ -1756,22 +1828,9 @@ void Instance::Private::prepareToDestroy() {
 	}
 	_mainSession = nullptr;
 
-	auto threads = std::vector<std::unique_ptr<QThread>>();
-	threads.push_back(base::take(_mainSessionThread));
-	threads.push_back(base::take(_otherSessionsThread));
-	for (auto &thread : base::take(_fileSessionThreads)) {
-		threads.push_back(std::move(thread));
-	}
-	for (const auto &thread : threads) {
-		if (thread) {
-			thread->quit();
-		}
-	}
-	for (const auto &thread : threads) {
-		if (thread) {
-			thread->wait();
-		}
-	}
+	// Other instances may still use the threads, so instead of stopping
+	// them just wait until the killed sessions are destroyed there.
+	_threads->flushDestroyed();
 }
 
 Instance::Instance(Mode mode, Fields &&fields)
@@ -1872,6 +1931,10 @@ QString Instance::dctransport(ShiftedDcId shiftedDcId) {
 	return _private->dctransport(shiftedDcId);
 }
 
+int Instance::connectedSessionsCount() const {
+	return _private->connectedSessionsCount();
+}
+
 void Instance::ping() {
 	_private->ping();
 }
@@ -2034,6 +2097,10 @@ void Instance::sendAnything(ShiftedDcId shiftedDcId, crl::time msCanWait) {
 	_private->getSession(shiftedDcId)->sendAnything(msCanWait);
 }
 
+crl::time Instance::batchWindow(RequestPriority priority) const {
+	return _private->batchWindow(priority);
+}
+
 rpl::lifetime &Instance::lifetime() {
 	return _private->lifetime();
 }
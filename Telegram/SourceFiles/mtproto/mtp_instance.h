@@ -22,12 +22,19 @@ class Session;
 
 class DcOptions;
 class Config;
+class SessionThreads;
 struct ConfigFields;
 class AuthKey;
 using AuthKeyPtr = std::shared_ptr<AuthKey>;
 using AuthKeysList = std::vector<AuthKeyPtr>;
 enum class Environment : uchar;
 
+enum class RequestPriority : uchar {
+	Interactive,
+	Background,
+	Media,
+};
+
 class Instance : public QObject {
 	Q_OBJECT
 
@@ -43,11 +50,23 @@ public:
 		static constexpr auto kDefaultMainDc = 2;
 		static constexpr auto kTemporaryMainDc = 1000;
 
+		static constexpr auto kDefaultBackgroundBatchWindow = crl::time(50);
+		static constexpr auto kDefaultMediaBatchWindow = crl::time(5);
+
 		std::unique_ptr<Config> config;
 		DcId mainDcId = kNotSetMainDc;
 		AuthKeysList keys;
 		QString deviceModel;
 		QString systemVersion;
+
+		// Shared with other instances of the same domain, if set.
+		std::shared_ptr<SessionThreads> threads;
+
+		// Batch windows of the non-interactive request priorities.
+		base::flat_map<RequestPriority, crl::time> batchWindows = {
+			{ RequestPriority::Background, kDefaultBackgroundBatchWindow },
+			{ RequestPriority::Media, kDefaultMediaBatchWindow },
+		};
 	};
 
 	enum class Mode {
@@ -93,6 +112,7 @@ public:
 	void restart(ShiftedDcId shiftedDcId);
 	int32 dcstate(ShiftedDcId shiftedDcId = 0);
 	QString dctransport(ShiftedDcId shiftedDcId = 0);
+	[[nodiscard]] int connectedSessionsCount() const;
 	void ping();
 	void cancel(mtpRequestId requestId);
 	int32 state(mtpRequestId requestId); // < 0 means waiting for such count of ms
@@ -144,6 +164,12 @@ public:
 
 	void sendAnything(ShiftedDcId shiftedDcId = 0, crl::time msCanWait = 0);
 
+	// Requests of non-interactive priorities may wait this long, so that
+	// their bursts are sent in fewer and fuller containers. Anything
+	// sent without waiting flushes the waiting requests as well.
+	// The windows are set in Fields::batchWindows.
+	[[nodiscard]] crl::time batchWindow(RequestPriority priority) const;
+
 	template <typename Request>
 	mtpRequestId send(
 			const Request &request,
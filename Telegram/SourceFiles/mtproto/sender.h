@@ -218,6 +218,11 @@ public:
 			setCanWait(ms);
 			return *this;
 		}
+		[[nodiscard]] SpecificRequestBuilder &priority(
+				RequestPriority value) noexcept {
+			setCanWait(sender()->instance().batchWindow(value));
+			return *this;
+		}
 
 		using Result = typename Request::ResponseType;
 		[[nodiscard]] SpecificRequestBuilder &done(
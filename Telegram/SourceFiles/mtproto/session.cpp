@@ -16,6 +16,47 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace MTP {
 namespace details {
+namespace {
+
+// Log main thread waits for the toSend lock longer than that.
+constexpr auto kLongLockWait = crl::profile_time(1000);
+
+// Takes the lock for writing, counting how long the main thread waited.
+class MeasuredWriteLocker final {
+public:
+	MeasuredWriteLocker(
+		not_null<QReadWriteLock*> lock,
+		std::atomic<int> &waits,
+		std::atomic<crl::profile_time> &waited)
+	: _lock(lock) {
+		if (_lock->tryLockForWrite()) {
+			return;
+		}
+		const auto started = crl::profile();
+		_lock->lockForWrite();
+		const auto duration = crl::profile() - started;
+		const auto count = ++waits;
+		const auto total = (waited += duration);
+		if (duration >= kLongLockWait) {
+			DEBUG_LOG(("MTP Info: waited %1 mcs for toSend lock, "
+				"%2 waits for %3 mcs total."
+				).arg(duration
+				).arg(count
+				).arg(total));
+		}
+	}
+	MeasuredWriteLocker(const MeasuredWriteLocker &other) = delete;
+	MeasuredWriteLocker &operator=(const MeasuredWriteLocker &other) = delete;
+	~MeasuredWriteLocker() {
+		_lock->unlock();
+	}
+
+private:
+	const not_null<QReadWriteLock*> _lock;
+
+};
+
+} // namespace
 
 SessionOptions::SessionOptions(
 	const QString &systemLangCode,
@@ -346,12 +387,14 @@ void Session::resetDone() {
 
 void Session::cancel(mtpRequestId requestId, mtpMsgId msgId) {
 	if (requestId) {
-		QWriteLocker locker(_data->toSendMutex());
+		const auto locker = MeasuredWriteLocker(
+			_data->toSendMutex(),
+			_toSendLockWaits,
+			_toSendLockWaited);
 		_data->toSendMap().remove(requestId);
 	}
 	if (msgId) {
-		QWriteLocker locker(_data->haveSentMutex());
-		_data->haveSentMap().remove(msgId);
+		_data->cancelSent(msgId);
 	}
 }
 
@@ -384,7 +427,10 @@ int32 Session::requestState(mtpRequestId requestId) const {
 		return MTP::RequestSent;
 	}
 
-	QWriteLocker locker(_data->toSendMutex());
+	const auto locker = MeasuredWriteLocker(
+		_data->toSendMutex(),
+		_toSendLockWaits,
+		_toSendLockWaited);
 	return _data->toSendMap().contains(requestId)
 		? MTP::RequestSending
 		: MTP::RequestSent;
@@ -423,7 +469,10 @@ void Session::sendPrepared(
 	DEBUG_LOG(("MTP Info: adding request to toSendMap, msCanWait %1"
 		).arg(msCanWait));
 	{
-		QWriteLocker locker(_data->toSendMutex());
+		const auto locker = MeasuredWriteLocker(
+			_data->toSendMutex(),
+			_toSendLockWaits,
+			_toSendLockWaited);
 		_data->toSendMap().emplace(request->requestId, request);
 		*(mtpMsgId*)(request->data() + 4) = 0;
 		*(request->data() + 6) = 0;
@@ -547,18 +596,18 @@ void Session::tryToReceive() {
 		return;
 	}
 	while (true) {
-		auto lock = QWriteLocker(_data->haveReceivedMutex());
-		const auto messages = base::take(_data->haveReceivedMessages());
-		lock.unlock();
-		if (messages.empty()) {
+		const auto batches = _data->takeReceived();
+		if (batches.empty()) {
 			break;
 		}
-		for (const auto &message : messages) {
-			if (message.requestId) {
-				_instance->processCallback(message);
-			} else if (_shiftedDcId == BareDcId(_shiftedDcId)) {
-				// Process updates only in main session.
-				_instance->processUpdate(message);
+		for (const auto &messages : batches) {
+			for (const auto &message : messages) {
+				if (message.requestId) {
+					_instance->processCallback(message);
+				} else if (_shiftedDcId == BareDcId(_shiftedDcId)) {
+					// Process updates only in main session.
+					_instance->processUpdate(message);
+				}
 			}
 		}
 	}
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtproto_response.h"
 #include "mtproto/mtproto_proxy_data.h"
 #include "mtproto/details/mtproto_serialized_request.h"
+#include "mtproto/details/mtproto_hand_off_queue.h"
 
 #include <QtCore/QTimer>
 
@@ -71,21 +72,29 @@ public:
 	not_null<QReadWriteLock*> toSendMutex() {
 		return &_toSendLock;
 	}
-	not_null<QReadWriteLock*> haveSentMutex() {
-		return &_haveSentLock;
-	}
-	not_null<QReadWriteLock*> haveReceivedMutex() {
-		return &_haveReceivedLock;
-	}
-
 	base::flat_map<mtpRequestId, SerializedRequest> &toSendMap() {
 		return _toSend;
 	}
+
+	// SessionPrivate thread only, no locking.
 	base::flat_map<mtpMsgId, SerializedRequest> &haveSentMap() {
 		return _haveSent;
 	}
-	std::vector<Response> &haveReceivedMessages() {
-		return _receivedMessages;
+
+	// Session -> SessionPrivate, sent requests that were cancelled.
+	void cancelSent(mtpMsgId msgId) {
+		_cancelledSent.push(std::move(msgId));
+	}
+	[[nodiscard]] std::vector<mtpMsgId> takeCancelledSent() {
+		return _cancelledSent.takeAll();
+	}
+
+	// SessionPrivate -> Session, returns true if a wakeup is needed.
+	bool pushReceived(std::vector<Response> &&messages) {
+		return _received.push(std::move(messages));
+	}
+	[[nodiscard]] std::vector<std::vector<Response>> takeReceived() {
+		return _received.takeAll();
 	}
 
 	// SessionPrivate -> Session interface.
@@ -123,10 +132,9 @@ private:
 	QReadWriteLock _toSendLock;
 
 	base::flat_map<mtpMsgId, SerializedRequest> _haveSent; // map of msg_id -> request, that was sent
-	QReadWriteLock _haveSentLock;
+	HandOffQueue<mtpMsgId> _cancelledSent;
 
-	std::vector<Response> _receivedMessages; // list of responses / updates that should be processed in the main thread
-	QReadWriteLock _haveReceivedLock;
+	HandOffQueue<std::vector<Response>> _received; // batches of responses / updates that should be processed in the main thread
 
 };
 
@@ -211,6 +219,9 @@ private:
 
 	bool _ping = false;
 
+	mutable std::atomic<int> _toSendLockWaits = 0;
+	mutable std::atomic<crl::profile_time> _toSendLockWaited = 0;
+
 	base::Timer _sender;
 
 	rpl::lifetime _lifetime;
@@ -50,6 +50,10 @@ constexpr auto kRequestConfigTimeout = 8 * crl::time(1000);
 // Don't try to handle messages larger than this size.
 constexpr auto kMaxMessageLength = 16 * 1024 * 1024;
 
+// Deflate can't compress better than that, bigger sizes in gzip trailer
+// are not trusted when preallocating the unpacked buffer.
+constexpr auto kMaxDeflateRatio = 1032;
+
 // How much time passed from send till we resend request or check its state.
 constexpr auto kCheckSentRequestTimeout = 10 * crl::time(1000);
 
@@ -64,6 +68,51 @@ auto SyncTimeRequestDuration = kFastRequestDuration;
 
 using namespace details;
 
+// Reads serialized bytes in place, without copying them to a QByteArray.
+[[nodiscard]] bytes::const_span ReadBytesInPlace(
+		const mtpPrime *&from,
+		const mtpPrime *end) {
+	if (from >= end) {
+		return {};
+	}
+	const auto data = reinterpret_cast<const bytes::type*>(from);
+	const auto available = size_t(end - from) * sizeof(mtpPrime);
+	const auto first = uint32(uchar(data[0]));
+	if (first == 255) {
+		return {};
+	}
+	const auto offset = (first == 254) ? size_t(4) : size_t(1);
+	const auto length = (first == 254)
+		? (uint32(uchar(data[1]))
+			| (uint32(uchar(data[2])) << 8)
+			| (uint32(uchar(data[3])) << 16))
+		: first;
+	const auto full = (offset + length + 3) & ~size_t(3);
+	if (full > available) {
+		return {};
+	}
+	from += full / sizeof(mtpPrime);
+	return bytes::const_span(data + offset, length);
+}
+
+// Unpacked size from the gzip trailer, in mtpPrime-s, if it looks sane.
+[[nodiscard]] uint32 UnpackedSizeHint(bytes::const_span packed) {
+	if (packed.size() < 18) { // Minimal gzip header and trailer.
+		return 0;
+	}
+	const auto tail = packed.data() + packed.size() - 4;
+	const auto size = uint32(uchar(tail[0]))
+		| (uint32(uchar(tail[1])) << 8)
+		| (uint32(uchar(tail[2])) << 16)
+		| (uint32(uchar(tail[3])) << 24);
+	if (!size
+		|| size > kMaxMessageLength
+		|| size / kMaxDeflateRatio > packed.size()) {
+		return 0;
+	}
+	return (size + sizeof(mtpPrime) - 1) / sizeof(mtpPrime);
+}
+
 [[nodiscard]] QString LogIdsVector(const QVector<MTPlong> &ids) {
 	if (!ids.size()) return "[]";
 	auto idsStr = QString("[%1").arg(ids.cbegin()->v);
@@ -176,6 +225,13 @@ SessionPrivate::~SessionPrivate() {
 	releaseKeyCreationOnFail();
 	doDisconnect();
 
+	if (_packetsWithRequestsSent > 0) {
+		DEBUG_LOG(("MTP Info: dc %1 sent %2 requests in %3 packets."
+			).arg(_shiftedDcId
+			).arg(_requestsSent
+			).arg(_packetsWithRequestsSent));
+	}
+
 	Expects(!_connection);
 	Expects(_testConnections.empty());
 }
@@ -263,8 +319,8 @@ void SessionPrivate::checkSentRequests() {
 	}
 	auto requesting = false;
 	auto nextTimeout = kCheckSentRequestTimeout;
+	applyCancelledSent();
 	{
-		QReadLocker locker(_sessionData->haveSentMutex());
 		auto &haveSent = _sessionData->haveSentMap();
 		for (const auto &[msgId, request] : haveSent) {
 			if (request->lastSentTime <= checkTime) {
@@ -286,6 +342,32 @@ void SessionPrivate::checkSentRequests() {
 	}
 }
 
+void SessionPrivate::applyCancelledSent() {
+	const auto cancelled = _sessionData->takeCancelledSent();
+	if (cancelled.empty()) {
+		return;
+	}
+	auto &haveSent = _sessionData->haveSentMap();
+	for (const auto msgId : cancelled) {
+		haveSent.remove(msgId);
+	}
+}
+
+void SessionPrivate::flushReceived() {
+	if (_receivedBatch.empty()) {
+		return;
+	}
+	const auto count = int(_receivedBatch.size());
+	if (_sessionData->pushReceived(base::take(_receivedBatch))) {
+		DEBUG_LOG(("MTP Info: queueTryToReceive() - "
+			"need to parse in another thread, %1 messages.").arg(count));
+		_sessionData->queueTryToReceive();
+	} else {
+		DEBUG_LOG(("MTP Info: appended %1 messages to the pending batch."
+			).arg(count));
+	}
+}
+
 void SessionPrivate::clearOldContainers() {
 	auto resent = false;
 	auto nextTimeout = kSentContainerLives;
@@ -474,7 +556,6 @@ mtpMsgId SessionPrivate::replaceMsgId(SerializedRequest &request, mtpMsgId newId
 	if (oldMsgId == newId) {
 		return newId;
 	}
-	// haveSentMutex() was locked in tryToSend()
 	auto &haveSent = _sessionData->haveSentMap();
 
 	while (_resendingIds.contains(newId)
@@ -569,6 +650,7 @@ void SessionPrivate::tryToSend() {
 		DEBUG_LOG(("MTP Info: not yet with auth key in dc %1.").arg(_shiftedDcId));
 		return;
 	}
+	applyCancelledSent();
 
 	const auto needsLayer = !_sessionData->connectionInited();
 	const auto state = getState();
@@ -700,6 +782,7 @@ void SessionPrivate::tryToSend() {
 
 	bool needAnyResponse = false;
 	SerializedRequest toSendRequest;
+	auto requestsInPacket = 0;
 	{
 		QWriteLocker locker1(_sessionData->toSendMutex());
 
@@ -724,6 +807,7 @@ void SessionPrivate::tryToSend() {
 		if (!toSendCount) {
 			return; // nothing to send
 		}
+		requestsInPacket = int(toSend.size());
 
 		const auto first = pingRequest
 			? pingRequest
@@ -767,7 +851,6 @@ void SessionPrivate::tryToSend() {
 				if (toSendRequest.needAck()) {
 					toSendRequest->lastSentTime = crl::now();
 
-					QWriteLocker locker2(_sessionData->haveSentMutex());
 					auto &haveSent = _sessionData->haveSentMap();
 					haveSent.emplace(msgId, toSendRequest);
 					scheduleCheckSentRequests = true;
@@ -834,8 +917,6 @@ void SessionPrivate::tryToSend() {
 			// check for a valid container
 			auto bigMsgId = base::unixtime::mtproto_msg_id();
 
-			// the fact of this lock is used in replaceMsgId()
-			QWriteLocker locker2(_sessionData->haveSentMutex());
 			auto &haveSent = _sessionData->haveSentMap();
 
 			// prepare sent container
@@ -952,6 +1033,10 @@ void SessionPrivate::tryToSend() {
 			}
 		}
 	}
+	if (requestsInPacket > 0) {
+		++_packetsWithRequestsSent;
+		_requestsSent += requestsInPacket;
+	}
 	sendSecureRequest(std::move(toSendRequest), needAnyResponse);
 }
 
@@ -1239,6 +1324,7 @@ void SessionPrivate::handleReceived() {
 	Expects(_encryptionKey != nullptr);
 
 	onReceivedSome();
+	applyCancelledSent();
 
 	while (!_connection->received().empty()) {
 		auto intsBuffer = std::move(_connection->received().front());
@@ -1380,14 +1466,7 @@ void SessionPrivate::handleReceived() {
 			_sessionData->queueSendAnything(kAckSendWaiting);
 		}
 
-		auto lock = QReadLocker(_sessionData->haveReceivedMutex());
-		const auto tryToReceive = !_sessionData->haveReceivedMessages().empty();
-		lock.unlock();
-
-		if (tryToReceive) {
-			DEBUG_LOG(("MTP Info: queueTryToReceive() - need to parse in another thread, %1 messages.").arg(_sessionData->haveReceivedMessages().size()));
-			_sessionData->queueTryToReceive();
-		}
+		flushReceived();
 
 		if (res != HandleResult::Success && res != HandleResult::Ignored) {
 			if (res == HandleResult::DestroyTemporaryKey) {
@@ -1593,8 +1672,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 				)).write(reply);
 
 				// Save rpc_error for processing in the main thread.
-				QWriteLocker locker(_sessionData->haveReceivedMutex());
-				_sessionData->haveReceivedMessages().push_back({
+				_receivedBatch.push_back({
 					.reply = std::move(reply),
 					.outerMsgId = info.outerMsgId,
 					.requestId = requestId,
@@ -1816,8 +1894,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		const auto requestId = wasSent(requestMsgId);
 		if (requestId && requestId != mtpRequestId(0xFFFFFFFF)) {
 			// Save rpc_result for processing in the main thread.
-			QWriteLocker locker(_sessionData->haveReceivedMutex());
-			_sessionData->haveReceivedMessages().push_back({
+			_receivedBatch.push_back({
 				.reply = std::move(response),
 				.outerMsgId = info.outerMsgId,
 				.requestId = requestId,
@@ -1850,7 +1927,6 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		mtpMsgId firstMsgId = data.vfirst_msg_id().v;
 		QVector<quint64> toResend;
 		{
-			QReadLocker locker(_sessionData->haveSentMutex());
 			const auto &haveSent = _sessionData->haveSentMap();
 			toResend.reserve(haveSent.size());
 			for (const auto &[msgId, request] : haveSent) {
@@ -1869,8 +1945,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		if (from > start) memcpy(update.data(), start, (from - start) * sizeof(mtpPrime));
 
 		// Notify main process about new session - need to get difference.
-		QWriteLocker locker(_sessionData->haveReceivedMutex());
-		_sessionData->haveReceivedMessages().push_back({
+		_receivedBatch.push_back({
 			.reply = update,
 			.outerMsgId = info.outerMsgId,
 		});
@@ -1919,8 +1994,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		}
 
 		// Notify main process about the new updates.
-		QWriteLocker locker(_sessionData->haveReceivedMutex());
-		_sessionData->haveReceivedMessages().push_back({
+		_receivedBatch.push_back({
 			.reply = update,
 			.outerMsgId = info.outerMsgId,
 		});
@@ -1966,12 +2040,19 @@ mtpBuffer SessionPrivate::ungzip(const mtpPrime *from, const mtpPrime *end) cons
 	mtpBuffer result; // * 4 because of mtpPrime type
 	result.resize(0);
 
-	MTPstring packed;
-	if (!packed.read(from, end)) { // read packed string as serialized mtp string type
+	// Inflate right from the received buffer.
+	const auto packed = ReadBytesInPlace(from, end);
+	if (packed.empty()) {
 		LOG(("RPC Error: could not read gziped bytes."));
 		return result;
 	}
-	uint32 packedLen = packed.v.size(), unpackedChunk = packedLen;
+	uint32 packedLen = packed.size(), unpackedChunk = packedLen;
+
+	// The whole result fits in the first chunk if the trailer is right,
+	// one more mtpPrime makes inflate() finish with some avail_out left.
+	if (const auto hint = UnpackedSizeHint(packed)) {
+		unpackedChunk = hint + 1;
+	}
 
 	z_stream stream;
 	stream.zalloc = 0;
@@ -1985,18 +2066,20 @@ mtpBuffer SessionPrivate::ungzip(const mtpPrime *from, const mtpPrime *end) cons
 		return result;
 	}
 	stream.avail_in = packedLen;
-	stream.next_in = reinterpret_cast<Bytef*>(packed.v.data());
+	stream.next_in = reinterpret_cast<Bytef*>(
+		const_cast<bytes::type*>(packed.data()));
 
 	stream.avail_out = 0;
 	while (!stream.avail_out) {
 		result.resize(result.size() + unpackedChunk);
 		stream.avail_out = unpackedChunk * sizeof(mtpPrime);
 		stream.next_out = (Bytef*)&result[result.size() - unpackedChunk];
+		unpackedChunk = packedLen;
 		int res = inflate(&stream, Z_NO_FLUSH);
 		if (res != Z_OK && res != Z_STREAM_END) {
 			inflateEnd(&stream);
 			LOG(("RPC Error: could not unpack gziped data, code: %1").arg(res));
-			DEBUG_LOG(("RPC Error: bad gzip: %1").arg(Logs::mb(packed.v.constData(), packedLen).str()));
+			DEBUG_LOG(("RPC Error: bad gzip: %1").arg(Logs::mb(packed.data(), packedLen).str()));
 			return mtpBuffer();
 		}
 	}
@@ -2033,7 +2116,6 @@ void SessionPrivate::correctUnixtimeByFastRequest(
 		TimeId serverTime) {
 	const auto now = crl::now();
 
-	QReadLocker locker(_sessionData->haveSentMutex());
 	const auto &haveSent = _sessionData->haveSentMap();
 	for (const auto &id : ids) {
 		const auto i = haveSent.find(id.v);
@@ -2044,8 +2126,6 @@ void SessionPrivate::correctUnixtimeByFastRequest(
 		if (duration < 0 || duration > SyncTimeRequestDuration) {
 			continue;
 		}
-		locker.unlock();
-
 		SyncTimeRequestDuration = duration;
 		base::unixtime::update(serverTime, true);
 		return;
@@ -2062,7 +2142,6 @@ void SessionPrivate::requestsAcked(const QVector<MTPlong> &ids, bool byResponse)
 
 	QVector<MTPlong> toAckMore;
 	{
-		QWriteLocker locker2(_sessionData->haveSentMutex());
 		auto &haveSent = _sessionData->haveSentMap();
 
 		for (const auto &wrappedMsgId : ids) {
@@ -2155,7 +2234,6 @@ void SessionPrivate::handleMsgsStates(const QVector<MTPlong> &ids, const QByteAr
 		const auto state = states[i];
 		const auto requestMsgId = ids[i].v;
 		{
-			QReadLocker locker(_sessionData->haveSentMutex());
 			if (!_sessionData->haveSentMap().contains(requestMsgId)) {
 				DEBUG_LOG(("Message Info: state was received for msgId %1, but request is not found, looking in resent requests...").arg(requestMsgId));
 				const auto reqIt = _resendingIds.find(requestMsgId);
@@ -2210,7 +2288,6 @@ void SessionPrivate::resend(mtpMsgId msgId, crl::time msCanWait) {
 		}
 		return;
 	}
-	auto lock = QWriteLocker(_sessionData->haveSentMutex());
 	auto &haveSent = _sessionData->haveSentMap();
 	auto i = haveSent.find(msgId);
 	if (i == haveSent.end()) {
@@ -2218,7 +2295,6 @@ void SessionPrivate::resend(mtpMsgId msgId, crl::time msCanWait) {
 	}
 	auto request = i->second;
 	haveSent.erase(i);
-	lock.unlock();
 
 	request->lastSentTime = crl::now();
 	request->forceSendInContainer = true;
@@ -2230,9 +2306,8 @@ void SessionPrivate::resend(mtpMsgId msgId, crl::time msCanWait) {
 }
 
 void SessionPrivate::resendAll() {
-	auto lock = QWriteLocker(_sessionData->haveSentMutex());
+	applyCancelledSent();
 	auto haveSent = base::take(_sessionData->haveSentMap());
-	lock.unlock();
 	{
 		auto lock = QWriteLocker(_sessionData->toSendMutex());
 		auto &toSend = _sessionData->toSendMap();
@@ -2660,7 +2735,6 @@ mtpRequestId SessionPrivate::wasSent(mtpMsgId msgId) const {
 	}
 
 	{
-		QReadLocker locker(_sessionData->haveSentMutex());
 		const auto &haveSent = _sessionData->haveSentMap();
 		const auto i = haveSent.find(msgId);
 		if (i != haveSent.end()) {
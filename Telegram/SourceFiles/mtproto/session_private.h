@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/details/mtproto_serialized_request.h"
 #include "mtproto/mtproto_auth_key.h"
 #include "mtproto/mtproto_dc_options.h"
+#include "mtproto/mtproto_response.h"
 #include "mtproto/connection_abstract.h"
 #include "mtproto/facade.h"
 #include "base/timer.h"
@@ -100,6 +101,8 @@ private:
 
 	void checkSentRequests();
 	void clearOldContainers();
+	void applyCancelledSent();
+	void flushReceived();
 
 	mtpMsgId placeToContainer(
 		SerializedRequest &toSendRequest,
@@ -223,6 +226,8 @@ private:
 	uint64 _sessionId = 0;
 	uint64 _sessionSalt = 0;
 	uint32 _messagesCounter = 0;
+	int64 _requestsSent = 0;
+	int64 _packetsWithRequestsSent = 0;
 	bool _sessionMarkedAsStarted = false;
 
 	QVector<MTPlong> _ackRequestData;
@@ -233,6 +238,7 @@ private:
 	base::flat_map<mtpMsgId, mtpRequestId> _ackedIds;
 	base::flat_map<mtpMsgId, SerializedRequest> _stateAndResendRequests;
 	base::flat_map<mtpMsgId, SentContainer> _sentContainers;
+	std::vector<Response> _receivedBatch;
 
 	std::unique_ptr<BoundKeyCreator> _keyCreator;
 	mtpMsgId _bindMsgId = 0;
@@ -0,0 +1,119 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/session_threads.h"
+
+#include "mtproto/facade.h"
+
+#include <QtCore/QThread>
+#include <QtCore/QCoreApplication>
+
+namespace MTP {
+
+SessionThreads::SessionThreads() {
+	const auto idealThreadPoolSize = QThread::idealThreadCount();
+	_files.resize(2 * std::max(idealThreadPoolSize / 2, 1));
+}
+
+SessionThreads::~SessionThreads() {
+	const auto all = [&](auto &&callback) {
+		callback(_main);
+		callback(_other);
+		for (auto &thread : _files) {
+			callback(thread);
+		}
+	};
+	all([](Thread &thread) {
+		if (thread.thread) {
+			thread.thread->quit();
+		}
+	});
+	all([](Thread &thread) {
+		if (thread.thread) {
+			thread.thread->wait();
+		}
+	});
+}
+
+not_null<QThread*> SessionThreads::forDc(ShiftedDcId shiftedDcId) {
+	if (shiftedDcId == BareDcId(shiftedDcId)) {
+		return ensureStarted(_main, "MTP Main Session");
+	} else if (isDownloadDcId(shiftedDcId)) {
+		const auto index = GetDcIdShift(shiftedDcId) - kBaseDownloadDcShift;
+		const auto composed = index + BareDcId(shiftedDcId);
+		return findFileThread("Download", composed, false);
+	} else if (isUploadDcId(shiftedDcId)) {
+		const auto index = GetDcIdShift(shiftedDcId) - kBaseUploadDcShift;
+		const auto composed = index + BareDcId(shiftedDcId);
+		return findFileThread("Upload", composed, true);
+	}
+	return ensureStarted(_other, "MTP Other Session");
+}
+
+not_null<QThread*> SessionThreads::ensureStarted(
+		Thread &thread,
+		const QString &name) {
+	if (!thread.thread) {
+		thread.thread = std::make_unique<QThread>();
+		thread.thread->setObjectName(name);
+		thread.thread->start();
+
+		thread.context = std::make_unique<QObject>();
+		thread.context->moveToThread(thread.thread.get());
+	}
+	return thread.thread.get();
+}
+
+not_null<QThread*> SessionThreads::findFileThread(
+		const char *prefix,
+		int index,
+		bool shift) {
+	Expects(!_files.empty());
+	Expects(!(_files.size() % 2));
+
+	const auto count = int(_files.size());
+	index %= count;
+	if (index >= count / 2) {
+		index = (count - 1) - (index - count / 2);
+	}
+	if (shift) {
+		index = (index + count / 2) % count;
+	}
+	return ensureStarted(
+		_files[index],
+		QString("MTP %1 Session (%2)").arg(prefix).arg(index));
+}
+
+void SessionThreads::flushDestroyed() {
+	const auto flush = [](Thread &thread) {
+		if (!thread.context) {
+			return;
+		}
+		QMetaObject::invokeMethod(thread.context.get(), [] {
+			QCoreApplication::sendPostedEvents(
+				nullptr,
+				QEvent::DeferredDelete);
+		}, Qt::BlockingQueuedConnection);
+	};
+	flush(_main);
+	flush(_other);
+	for (auto &thread : _files) {
+		flush(thread);
+	}
+}
+
+int SessionThreads::startedCount() const {
+	auto result = (_main.thread ? 1 : 0) + (_other.thread ? 1 : 0);
+	for (const auto &thread : _files) {
+		if (thread.thread) {
+			++result;
+		}
+	}
+	return result;
+}
+
+} // namespace MTP
@@ -0,0 +1,53 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class QThread;
+
+namespace MTP {
+
+// Connection threads shared by all MTP::Instance-s of one Main::Domain.
+//
+// Sessions of different accounts still use their own auth keys and their
+// own sockets, but they are served by the same small set of threads
+// instead of a full set of threads per account.
+class SessionThreads final {
+public:
+	SessionThreads();
+	SessionThreads(const SessionThreads &other) = delete;
+	SessionThreads &operator=(const SessionThreads &other) = delete;
+	~SessionThreads();
+
+	[[nodiscard]] not_null<QThread*> forDc(ShiftedDcId shiftedDcId);
+
+	// Sessions are destroyed through deleteLater() on their threads.
+	// Blocks until all destructions already queued there are finished,
+	// so an Instance can go away without stopping the shared threads.
+	void flushDestroyed();
+
+	[[nodiscard]] int startedCount() const;
+
+private:
+	struct Thread {
+		std::unique_ptr<QThread> thread;
+		std::unique_ptr<QObject> context;
+	};
+
+	not_null<QThread*> ensureStarted(Thread &thread, const QString &name);
+	not_null<QThread*> findFileThread(
+		const char *prefix,
+		int index,
+		bool shift);
+
+	Thread _main;
+	Thread _other;
+	std::vector<Thread> _files;
+
+};
+
+} // namespace MTP
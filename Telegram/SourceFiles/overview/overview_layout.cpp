@@ -66,6 +66,30 @@ constexpr auto kMaxInlineArea = 1280 * 720;
 	return dimensions.width() * dimensions.height() <= kMaxInlineArea;
 }
 
+// Safe to call from any thread, works only with the QImage it is given.
+[[nodiscard]] QImage PrepareSquareThumbnail(
+		QImage original,
+		int size,
+		bool blurred) {
+	auto img = blurred
+		? Images::prepareBlur(std::move(original))
+		: std::move(original);
+	if (img.width() == img.height()) {
+		if (img.width() != size) {
+			img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+		}
+	} else if (img.width() > img.height()) {
+		img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	} else {
+		img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	}
+	img.setDevicePixelRatio(cRetinaFactor());
+	return img;
+}
+
+[[nodiscard]] int64 ThumbnailBytes(const QPixmap &pixmap) {
+	return int64(pixmap.width()) * pixmap.height() * 4;
+}
 
 } // namespace
 
@@ -325,15 +349,8 @@ void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const
 		if ((good && !_goodLoaded) || widthChanged) {
 			_goodLoaded = good;
 			_pix = QPixmap();
-			if (_goodLoaded) {
-				setPixFrom(_dataMedia->image(Data::PhotoSize::Large)
-					? _dataMedia->image(Data::PhotoSize::Large)
-					: _dataMedia->image(Data::PhotoSize::Thumbnail));
-			} else if (const auto small = _dataMedia->image(
-					Data::PhotoSize::Small)) {
-				setPixFrom(small);
-			} else if (const auto blurred = _dataMedia->thumbnailInline()) {
-				setPixFrom(blurred);
+			if (const auto image = chooseThumbnailSource(good)) {
+				setPixFrom(image);
 			}
 		}
 	}
@@ -353,23 +370,28 @@ void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	paintCheckbox(p, { checkLeft, checkTop }, selected, context);
 }
 
-void Photo::setPixFrom(not_null<Image*> image) {
-	const auto size = _width * cIntRetinaFactor();
-	auto img = image->original();
-	if (!_goodLoaded) {
-		img = Images::prepareBlur(std::move(img));
-	}
-	if (img.width() == img.height()) {
-		if (img.width() != size) {
-			img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		}
-	} else if (img.width() > img.height()) {
-		img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-	} else {
-		img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+Image *Photo::chooseThumbnailSource(bool good) const {
+	Expects(_dataMedia != nullptr);
+
+	if (good) {
+		const auto large = _dataMedia->image(Data::PhotoSize::Large);
+		return large
+			? large
+			: _dataMedia->image(Data::PhotoSize::Thumbnail);
+	} else if (const auto small = _dataMedia->image(Data::PhotoSize::Small)) {
+		return small;
 	}
-	img.setDevicePixelRatio(cRetinaFactor());
+	return _dataMedia->thumbnailInline();
+}
 
+void Photo::setPixFrom(not_null<Image*> image) {
+	setPix(PrepareSquareThumbnail(
+		image->original(),
+		_width * cIntRetinaFactor(),
+		!_goodLoaded));
+}
+
+void Photo::setPix(QImage &&image) {
 	// In case we have inline thumbnail we can unload all images and we still
 	// won't get a blank image in the media viewer when the photo is opened.
 	if (!_data->inlineThumbnailBytes().isEmpty()) {
@@ -377,7 +399,46 @@ void Photo::setPixFrom(not_null<Image*> image) {
 		delegate()->unregisterHeavyItem(this);
 	}
 
-	_pix = Ui::PixmapFromImage(std::move(img));
+	_pix = Ui::PixmapFromImage(std::move(image));
+	delegate()->registerThumbnail(this, ThumbnailBytes(_pix));
+}
+
+void Photo::prepareThumbnail() {
+	const auto size = _width * cIntRetinaFactor();
+	if (_pixPreparing || !size || (_goodLoaded && _pix.width() == size)) {
+		return;
+	}
+	ensureDataMediaCreated();
+	const auto good = _dataMedia->loaded()
+		|| (_dataMedia->image(Data::PhotoSize::Thumbnail) != nullptr);
+	const auto image = chooseThumbnailSource(good);
+	if (!image || (!good && _pix.width() == size)) {
+		return;
+	}
+	_pixPreparing = true;
+	const auto weak = base::make_weak(this);
+	crl::async([=, original = image->original()]() mutable {
+		auto prepared = PrepareSquareThumbnail(
+			std::move(original),
+			size,
+			!good);
+		crl::on_main(weak, [=, prepared = std::move(prepared)]() mutable {
+			_pixPreparing = false;
+			const auto wanted = (_width * cIntRetinaFactor() == size)
+				&& (good || !_goodLoaded)
+				&& (_pix.width() != size || (good && !_goodLoaded));
+			if (wanted) {
+				_goodLoaded = good;
+				setPix(std::move(prepared));
+				delegate()->repaintItem(this);
+			}
+		});
+	});
+}
+
+void Photo::clearThumbnail() {
+	_pix = QPixmap();
+	_goodLoaded = false;
 }
 
 void Photo::ensureDataMediaCreated() const {
@@ -448,28 +509,15 @@ void Video::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	const auto radial = isRadialAnimation();
 	const auto radialOpacity = radial ? _radial->opacity() : 0.;
 
-	if ((blurred || thumbnail || good)
-		&& ((_pix.width() != _width * cIntRetinaFactor())
-			|| (_pixBlurred && (thumbnail || good)))) {
-		auto size = _width * cIntRetinaFactor();
-		auto img = good
-			? good->original()
-			: thumbnail
-			? thumbnail->original()
-			: Images::prepareBlur(blurred->original());
-		if (img.width() == img.height()) {
-			if (img.width() != size) {
-				img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-			}
-		} else if (img.width() > img.height()) {
-			img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		} else {
-			img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		}
-		img.setDevicePixelRatio(cRetinaFactor());
-
-		_pix = Ui::PixmapFromImage(std::move(img));
-		_pixBlurred = !(thumbnail || good);
+	if (thumbnailOutdated()) {
+		const auto image = good ? good : thumbnail ? thumbnail : blurred;
+		const auto pixBlurred = !(thumbnail || good);
+		setPix(
+			PrepareSquareThumbnail(
+				image->original(),
+				_width * cIntRetinaFactor(),
+				pixBlurred),
+			pixBlurred);
 	}
 
 	if (_pix.isNull()) {
@@ -551,6 +599,64 @@ void Video::clearHeavyPart() {
 	_dataMedia = nullptr;
 }
 
+bool Video::thumbnailOutdated() const {
+	Expects(_dataMedia != nullptr);
+
+	const auto blurred = _dataMedia->thumbnailInline();
+	const auto thumbnail = _dataMedia->thumbnail();
+	const auto good = _dataMedia->goodThumbnail();
+	return (blurred || thumbnail || good)
+		&& ((_pix.width() != _width * cIntRetinaFactor())
+			|| (_pixBlurred && (thumbnail || good)));
+}
+
+void Video::setPix(QImage &&image, bool blurred) {
+	_pix = Ui::PixmapFromImage(std::move(image));
+	_pixBlurred = blurred;
+	delegate()->registerThumbnail(this, ThumbnailBytes(_pix));
+}
+
+void Video::prepareThumbnail() {
+	const auto size = _width * cIntRetinaFactor();
+	if (_pixPreparing || !size) {
+		return;
+	}
+	ensureDataMediaCreated();
+	if (!thumbnailOutdated()) {
+		return;
+	}
+	const auto thumbnail = _dataMedia->thumbnail();
+	const auto good = _dataMedia->goodThumbnail();
+	const auto image = good
+		? good
+		: thumbnail
+		? thumbnail
+		: _dataMedia->thumbnailInline();
+	const auto blurred = !(thumbnail || good);
+	_pixPreparing = true;
+	const auto weak = base::make_weak(this);
+	crl::async([=, original = image->original()]() mutable {
+		auto prepared = PrepareSquareThumbnail(
+			std::move(original),
+			size,
+			blurred);
+		crl::on_main(weak, [=, prepared = std::move(prepared)]() mutable {
+			_pixPreparing = false;
+			const auto wanted = (_width * cIntRetinaFactor() == size)
+				&& (_pix.width() != size || (_pixBlurred && !blurred));
+			if (wanted) {
+				setPix(std::move(prepared), blurred);
+				delegate()->repaintItem(this);
+			}
+		});
+	});
+}
+
+void Video::clearThumbnail() {
+	_pix = QPixmap();
+	_pixBlurred = true;
+}
+
 float64 Video::dataProgress() const {
 	ensureDataMediaCreated();
 	return _dataMedia->progress();
@@ -67,6 +67,14 @@ public:
 	virtual void clearHeavyPart() {
 	}
 
+	// Grid items keep a prepared thumbnail pixmap, the delegate asks to
+	// prepare it in the background before the item is shown and to drop
+	// it when the item is far away.
+	virtual void prepareThumbnail() {
+	}
+	virtual void clearThumbnail() {
+	}
+
 protected:
 	[[nodiscard]] not_null<HistoryItem*> parent() const {
 		return _parent;
@@ -184,10 +192,14 @@ public:
 		StateRequest request) const override;
 
 	void clearHeavyPart() override;
+	void prepareThumbnail() override;
+	void clearThumbnail() override;
 
 private:
 	void ensureDataMediaCreated() const;
+	[[nodiscard]] Image *chooseThumbnailSource(bool good) const;
 	void setPixFrom(not_null<Image*> image);
+	void setPix(QImage &&image);
 
 	const not_null<PhotoData*> _data;
 	mutable std::shared_ptr<Data::PhotoMedia> _dataMedia;
@@ -195,6 +207,7 @@ private:
 
 	QPixmap _pix;
 	bool _goodLoaded = false;
+	bool _pixPreparing = false;
 
 };
 
@@ -272,6 +285,8 @@ public:
 		StateRequest request) const override;
 
 	void clearHeavyPart() override;
+	void prepareThumbnail() override;
+	void clearThumbnail() override;
 
 protected:
 	float64 dataProgress() const override;
@@ -282,6 +297,8 @@ protected:
 private:
 	void ensureDataMediaCreated() const;
 	void updateStatusText();
+	[[nodiscard]] bool thumbnailOutdated() const;
+	void setPix(QImage &&image, bool blurred);
 
 	const not_null<DocumentData*> _data;
 	mutable std::shared_ptr<Data::DocumentMedia> _dataMedia;
@@ -290,6 +307,7 @@ private:
 	QString _duration;
 	QPixmap _pix;
 	bool _pixBlurred = true;
+	bool _pixPreparing = false;
 
 };
 
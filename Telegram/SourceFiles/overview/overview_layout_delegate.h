@@ -16,6 +16,9 @@ class Delegate {
 public:
 	virtual void registerHeavyItem(not_null<const ItemBase*> item) = 0;
 	virtual void unregisterHeavyItem(not_null<const ItemBase*> item) = 0;
+	virtual void registerThumbnail(
+		not_null<const ItemBase*> item,
+		int64 bytes) = 0;
 	virtual void repaintItem(not_null<const ItemBase*> item) = 0;
 	virtual bool itemVisible(not_null<const ItemBase*> item) = 0;
 
@@ -75,6 +75,8 @@ DeclareSetting(bool, WriteProtected);
 DeclareSetting(int32, LastUpdateCheck);
 DeclareSetting(bool, NoStartUpdate);
 DeclareSetting(bool, StartToSettings);
+DeclareSetting(bool, TraceStartup);
+DeclareSetting(bool, DeferredInit);
 DeclareSetting(bool, DebugMode);
 DeclareReadSetting(bool, ManyInstance);
 DeclareSetting(bool, Quit);
@@ -544,6 +544,50 @@ void SetupAnimations(not_null<Ui::VerticalLayout*> container) {
 	}, container->lifetime());
 }
 
+void SetupLoadedHistoryViews(
+		not_null<Window::SessionController*> controller,
+		not_null<Ui::VerticalLayout*> container) {
+	const auto limits = std::vector{ 5000, 20000, 50000 };
+	const auto text = [](int limit) {
+		return tr::lng_settings_loaded_messages_count(
+			tr::now,
+			lt_count_decimal,
+			limit);
+	};
+	const auto current = container->lifetime().make_state<
+		rpl::variable<int>
+	>(Core::App().settings().loadedHistoryViewsLimit());
+	const auto button = AddButtonWithLabel(
+		container,
+		tr::lng_settings_loaded_messages(),
+		current->value() | rpl::map(text),
+		st::settingsButton);
+	button->addClickHandler([=] {
+		const auto i = ranges::lower_bound(limits, current->current());
+		const auto selected = (i != end(limits))
+			? int(i - begin(limits))
+			: int(limits.size() - 1);
+		controller->show(Box([=](not_null<Ui::GenericBox*> box) {
+			const auto save = [=](int index) {
+				Core::App().settings().setLoadedHistoryViewsLimit(
+					limits[index]);
+				Core::App().saveSettingsDelayed();
+				*current = limits[index];
+			};
+			SingleChoiceBox(box, {
+				.title = tr::lng_settings_loaded_messages(),
+				.options = ranges::views::all(
+					limits
+				) | ranges::views::transform(
+					text
+				) | ranges::to_vector,
+				.initialSelection = selected,
+				.callback = save,
+			});
+		}));
+	});
+}
+
 #ifdef Q_OS_WIN
 void SetupANGLE(
 		not_null<Window::SessionController*> controller,
@@ -655,6 +699,7 @@ void SetupPerformance(
 		not_null<Window::SessionController*> controller,
 		not_null<Ui::VerticalLayout*> container) {
 	SetupAnimations(container);
+	SetupLoadedHistoryViews(controller, container);
 #ifdef Q_OS_WIN
 	SetupANGLE(controller, container);
 #else // Q_OS_WIN
@@ -52,6 +52,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/call_delayed.h"
 #include "support/support_common.h"
 #include "support/support_templates.h"
+#include "main/main_domain.h"
 #include "main/main_session.h"
 #include "main/main_session_settings.h"
 #include "mainwidget.h"
@@ -843,6 +844,24 @@ void SetupLocalStorage(
 	)->addClickHandler([=] {
 		LocalStorageBox::Show(&controller->session());
 	});
+
+	if (Core::App().domain().accounts().size() < 2) {
+		return;
+	}
+	const auto shared = AddButton(
+		container,
+		tr::lng_settings_shared_media_cache(),
+		st::settingsButton
+	)->toggleOn(rpl::single(Core::App().settings().sharedMediaCache()));
+
+	shared->toggledValue(
+	) | rpl::filter([](bool checked) {
+		return (checked != Core::App().settings().sharedMediaCache());
+	}) | rpl::start_with_next([=](bool checked) {
+		Core::App().settings().setSharedMediaCache(checked);
+		Core::App().saveSettingsDelayed();
+		Core::App().domain().clearSharedCacheBigFileIfUnused();
+	}, shared->lifetime());
 }
 
 void SetupDataStorage(
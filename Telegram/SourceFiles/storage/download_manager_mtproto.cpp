@@ -523,7 +523,7 @@ mtpRequestId DownloadMtprotoTask::sendRequest(
 			cdnPartLoaded(result, id);
 		}).fail([=](const MTP::Error &error, mtpRequestId id) {
 			cdnPartFailed(error, id);
-		}).toDC(shiftedDcId).send();
+		}).toDC(shiftedDcId).priority(MTP::RequestPriority::Media).send();
 	}
 	return v::match(_location.data, [&](const WebFileLocation &location) {
 		return api().request(MTPupload_GetWebFile(
@@ -536,7 +536,7 @@ mtpRequestId DownloadMtprotoTask::sendRequest(
 			webPartLoaded(result, id);
 		}).fail([=](const MTP::Error &error, mtpRequestId id) {
 			partFailed(error, id);
-		}).toDC(shiftedDcId).send();
+		}).toDC(shiftedDcId).priority(MTP::RequestPriority::Media).send();
 	}, [&](const GeoPointLocation &location) {
 		return api().request(MTPupload_GetWebFile(
 			MTP_inputWebFileGeoPointLocation(
@@ -556,7 +556,7 @@ mtpRequestId DownloadMtprotoTask::sendRequest(
 			webPartLoaded(result, id);
 		}).fail([=](const MTP::Error &error, mtpRequestId id) {
 			partFailed(error, id);
-		}).toDC(shiftedDcId).send();
+		}).toDC(shiftedDcId).priority(MTP::RequestPriority::Media).send();
 	}, [&](const StorageFileLocation &location) {
 		const auto reference = location.fileReference();
 		return api().request(MTPupload_GetFile(
@@ -568,7 +568,7 @@ mtpRequestId DownloadMtprotoTask::sendRequest(
 			normalPartLoaded(result, id);
 		}).fail([=](const MTP::Error &error, mtpRequestId id) {
 			normalPartFailed(reference, error, id);
-		}).toDC(shiftedDcId).send();
+		}).toDC(shiftedDcId).priority(MTP::RequestPriority::Media).send();
 	});
 }
 
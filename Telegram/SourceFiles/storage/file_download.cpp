@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_account.h"
 #include "storage/file_download_mtproto.h"
 #include "storage/file_download_web.h"
+#include "storage/file_download_writer.h"
 #include "platform/platform_file_utilities.h"
 #include "main/main_session.h"
 #include "apiwrap.h"
@@ -104,7 +105,6 @@ FileLoader::FileLoader(
 , _autoLoading(autoLoading)
 , _cacheTag(cacheTag)
 , _filename(toFile)
-, _file(_filename)
 , _toCache(toCache)
 , _fromCloud(fromCloud)
 , _loadSize(loadSize)
@@ -126,25 +126,22 @@ void FileLoader::finishWithBytes(const QByteArray &data) {
 	_data = data;
 	_localStatus = LocalStatus::Loaded;
 	if (!_filename.isEmpty() && _toCache == LoadToCacheAsWell) {
-		if (!_fileIsOpen) _fileIsOpen = _file.open(QIODevice::WriteOnly);
-		if (!_fileIsOpen) {
+		if (!_writer && !openWriter()) {
 			cancel(true);
 			return;
 		}
-		_file.seek(0);
-		if (_file.write(_data) != qint64(_data.size())) {
+		_writer->write(0, bytes::make_span(_data));
+	}
+	if (_writer) {
+		if (!_writer->finish()) {
 			cancel(true);
 			return;
 		}
-	}
-
-	_finished = true;
-	if (_fileIsOpen) {
-		_file.close();
-		_fileIsOpen = false;
+		_writer = nullptr;
 		Platform::File::PostprocessDownloaded(
-			QFileInfo(_file).absoluteFilePath());
+			QFileInfo(_filename).absoluteFilePath());
 	}
+	_finished = true;
 	const auto session = _session;
 	_updates.fire_done();
 	session->notifyDownloaderTaskFinished();
@@ -185,7 +182,6 @@ bool FileLoader::setFileName(const QString &fileName) {
 		return fileName.isEmpty() || (fileName == _filename);
 	}
 	_filename = fileName;
-	_file.setFileName(_filename);
 	return true;
 }
 
@@ -251,17 +247,32 @@ void FileLoader::start() {
 bool FileLoader::checkForOpen() {
 	if (_filename.isEmpty()
 		|| (_toCache != LoadToFileOnly)
-		|| _fileIsOpen) {
+		|| _writer) {
 		return true;
-	}
-	_fileIsOpen = _file.open(QIODevice::WriteOnly);
-	if (_fileIsOpen) {
+	} else if (openWriter()) {
 		return true;
 	}
 	cancel(true);
 	return false;
 }
 
+bool FileLoader::openWriter() {
+	Expects(!_writer);
+
+	auto writer = std::make_unique<Storage::DownloadFileWriter>(
+		_filename,
+		[=] { writerReadyHook(); });
+	if (!writer->open()) {
+		return false;
+	}
+	_writer = std::move(writer);
+	return true;
+}
+
+bool FileLoader::writerBusy() const {
+	return _writer && _writer->busy();
+}
+
 void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 	const auto readImage = (_locationType != AudioFileLocation);
 	auto done = [=, guard = _localLoading.make_guard()](
@@ -339,10 +350,8 @@ void FileLoader::cancel(bool fail) {
 
 	_cancelled = true;
 	_finished = true;
-	if (_fileIsOpen) {
-		_file.close();
-		_fileIsOpen = false;
-		_file.remove();
+	if (const auto writer = base::take(_writer)) {
+		writer->remove();
 	}
 	_data = QByteArray();
 
@@ -354,12 +363,11 @@ void FileLoader::cancel(bool fail) {
 	}
 	if (weak) {
 		_filename = QString();
-		_file.setFileName(_filename);
 	}
 }
 
 int FileLoader::currentOffset() const {
-	return (_fileIsOpen ? _file.size() : _data.size()) - _skippedBytes;
+	return (_writer ? _writer->size() : _data.size()) - _skippedBytes;
 }
 
 bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
@@ -368,21 +376,30 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 	if (buffer.empty()) {
 		return true;
 	}
-	if (_fileIsOpen) {
-		auto fsize = _file.size();
+	if (_writer) {
+		const auto fsize = _writer->size();
 		if (offset < fsize) {
 			_skippedBytes -= buffer.size();
 		} else if (offset > fsize) {
 			_skippedBytes += offset - fsize;
 		}
-		_file.seek(offset);
-		if (_file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()) != qint64(buffer.size())) {
+		_writer->write(offset, buffer);
+		if (_writer->failed()) {
 			cancel(true);
 			return false;
 		}
 		return true;
 	}
-	_data.reserve(offset + buffer.size());
+	const auto required = offset + int(buffer.size());
+	if (_data.capacity() < required) {
+		// Grow geometrically instead of reallocating for each part.
+		const auto wanted = (_fullSize >= required)
+			? _fullSize
+			: (int(_data.capacity()) * 2);
+		_data.reserve(std::max(
+			required,
+			std::min(wanted, Storage::kMaxFileInMemory)));
+	}
 	if (offset > _data.size()) {
 		_skippedBytes += offset - _data.size();
 		_data.resize(offset);
@@ -405,19 +422,12 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 QByteArray FileLoader::readLoadedPartBack(int offset, int size) {
 	Expects(offset >= 0 && size > 0);
 
-	if (_fileIsOpen) {
-		if (_file.openMode() == QIODevice::WriteOnly) {
-			_file.close();
-			_fileIsOpen = _file.open(QIODevice::ReadWrite);
-			if (!_fileIsOpen) {
-				cancel(true);
-				return QByteArray();
-			}
-		}
-		if (!_file.seek(offset)) {
+	if (_writer) {
+		auto result = _writer->read(offset, size);
+		if (_writer->failed()) {
+			cancel(true);
 			return QByteArray();
 		}
-		auto result = _file.read(size);
 		return (result.size() == size) ? result : QByteArray();
 	}
 	return (offset + size <= _data.size())
@@ -429,23 +439,37 @@ bool FileLoader::finalizeResult() {
 	Expects(!_finished);
 
 	if (!_filename.isEmpty() && (_toCache == LoadToCacheAsWell)) {
-		if (!_fileIsOpen) {
-			_fileIsOpen = _file.open(QIODevice::WriteOnly);
+		if (!_writer && !openWriter()) {
+			cancel(true);
+			return false;
 		}
-		_file.seek(0);
-		if (!_fileIsOpen || _file.write(_data) != qint64(_data.size())) {
+		_writer->write(0, bytes::make_span(_data));
+	}
+	if (_writer) {
+		if (_writer->failed()) {
 			cancel(true);
 			return false;
 		}
+		// The parts may still be waiting for the disk,
+		// the rest is done when all of them are written.
+		_writer->finish([=](bool success) {
+			if (!success) {
+				cancel(true);
+				return;
+			}
+			_writer = nullptr;
+			Platform::File::PostprocessDownloaded(
+				QFileInfo(_filename).absoluteFilePath());
+			finalizeWritten();
+		});
+		return true;
 	}
+	finalizeWritten();
+	return true;
+}
 
+void FileLoader::finalizeWritten() {
 	_finished = true;
-	if (_fileIsOpen) {
-		_file.close();
-		_fileIsOpen = false;
-		Platform::File::PostprocessDownloaded(
-			QFileInfo(_file).absoluteFilePath());
-	}
 	if (_localStatus == LocalStatus::NotFound) {
 		if (const auto key = fileLocationKey()) {
 			if (!_filename.isEmpty()) {
@@ -470,7 +494,6 @@ bool FileLoader::finalizeResult() {
 	const auto session = _session;
 	_updates.fire_done();
 	session->notifyDownloaderTaskFinished();
-	return true;
 }
 
 std::unique_ptr<FileLoader> CreateFileLoader(
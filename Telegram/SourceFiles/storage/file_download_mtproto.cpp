@@ -107,7 +107,8 @@ bool mtpFileLoader::readyToRequest() const {
 	return !_finished
 		&& !_lastComplete
 		&& (_fullSize != 0 || !haveSentRequests())
-		&& (!_fullSize || _nextRequestOffset < _loadSize);
+		&& (!_fullSize || _nextRequestOffset < _loadSize)
+		&& !writerBusy();
 }
 
 int mtpFileLoader::takeNextRequestOffset() {
@@ -177,6 +178,12 @@ void mtpFileLoader::cancelHook() {
 	cancelAllRequests();
 }
 
+void mtpFileLoader::writerReadyHook() {
+	if (readyToRequest()) {
+		addToQueue();
+	}
+}
+
 Storage::Cache::Key mtpFileLoader::cacheKey() const {
 	return v::match(location().data, [&](const WebFileLocation &location) {
 		return Data::WebDocumentCacheKey(location);
@@ -53,6 +53,7 @@ private:
 	void startLoading() override;
 	void startLoadingWithPartial(const QByteArray &data) override;
 	void cancelHook() override;
+	void writerReadyHook() override;
 
 	bool readyToRequest() const override;
 	int takeNextRequestOffset() override;
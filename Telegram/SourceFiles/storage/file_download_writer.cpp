@@ -0,0 +1,263 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/file_download_writer.h"
+
+#include <crl/crl_queue.h>
+
+namespace Storage {
+namespace {
+
+// Downloaded parts are 128 KB, so write them by eight at once.
+constexpr auto kCoalesceWritesSize = 1024 * 1024;
+
+// Parts are not requested while that much waits for the disk.
+constexpr auto kMaxPendingBytes = 8 * kCoalesceWritesSize;
+
+[[nodiscard]] crl::queue &WritersQueue() {
+	static crl::queue result;
+	return result;
+}
+
+} // namespace
+
+struct DownloadFileWriter::Worker {
+	explicit Worker(const QString &path);
+
+	// Queue only.
+	void open();
+	void write(int64 offset, const QByteArray &bytes);
+	void finish(int64 size);
+	void remove();
+	void fail();
+
+	const QString path;
+	std::unique_ptr<QFile> file;
+
+	// Any thread.
+	std::atomic<bool> failed = false;
+	std::atomic<int> written = 0;
+	std::atomic<bool> waiting = false;
+};
+
+DownloadFileWriter::Worker::Worker(const QString &path) : path(path) {
+}
+
+void DownloadFileWriter::Worker::open() {
+	file = std::make_unique<QFile>(path);
+	if (!file->open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+		fail();
+	}
+}
+
+void DownloadFileWriter::Worker::write(
+		int64 offset,
+		const QByteArray &bytes) {
+	if (!failed
+		&& (!file->seek(offset)
+			|| file->write(bytes) != qint64(bytes.size())
+			|| !file->flush())) {
+		fail();
+	}
+	++written;
+}
+
+void DownloadFileWriter::Worker::finish(int64 size) {
+	if (failed) {
+		return;
+	} else if (file->size() != size && !file->resize(size)) {
+		fail();
+	}
+	file->close();
+}
+
+void DownloadFileWriter::Worker::remove() {
+	if (file) {
+		file->close();
+	}
+	QFile::remove(path);
+}
+
+void DownloadFileWriter::Worker::fail() {
+	failed = true;
+	if (file) {
+		file->close();
+	}
+}
+
+DownloadFileWriter::DownloadFileWriter(const QString &path, Fn<void()> ready)
+: _path(path)
+, _ready(std::move(ready))
+, _reader(path) {
+}
+
+DownloadFileWriter::~DownloadFileWriter() = default;
+
+bool DownloadFileWriter::open() {
+	Expects(_worker == nullptr);
+
+	// Check that we can write here before going to background.
+	auto file = QFile(_path);
+	if (!file.open(QIODevice::WriteOnly)) {
+		return false;
+	}
+	file.close();
+	_worker = std::make_shared<Worker>(_path);
+	WritersQueue().async([worker = _worker] {
+		worker->open();
+	});
+	return true;
+}
+
+void DownloadFileWriter::write(int64 offset, bytes::const_span buffer) {
+	Expects(_worker != nullptr);
+	Expects(!_finishing);
+
+	prunePending();
+	if (!_buffer.isEmpty() && offset != _bufferOffset + _buffer.size()) {
+		flush();
+	}
+	if (_buffer.isEmpty()) {
+		_bufferOffset = offset;
+		_buffer.reserve(std::max(kCoalesceWritesSize, int(buffer.size())));
+	}
+	_buffer.append(
+		reinterpret_cast<const char*>(buffer.data()),
+		buffer.size());
+	_size = std::max(_size, offset + int64(buffer.size()));
+	if (_buffer.size() >= kCoalesceWritesSize) {
+		flush();
+	}
+}
+
+void DownloadFileWriter::flush() {
+	if (_buffer.isEmpty()) {
+		return;
+	}
+	// Keep the bytes until they're written, so they can be read back.
+	_pendingBytes += _buffer.size();
+	_pending.push_back({ _bufferOffset, base::take(_buffer) });
+	++_flushed;
+	WritersQueue().async([
+		=,
+		worker = _worker,
+		offset = _bufferOffset,
+		bytes = _pending.back().bytes,
+		weak = base::make_weak(this)
+	] {
+		worker->write(offset, bytes);
+		if (worker->waiting) {
+			crl::on_main(weak, [=] {
+				written();
+			});
+		}
+	});
+}
+
+void DownloadFileWriter::prunePending() {
+	const auto waiting = _flushed - _worker->written.load();
+	while (int(_pending.size()) > waiting) {
+		_pendingBytes -= _pending.front().bytes.size();
+		_pending.pop_front();
+	}
+}
+
+bool DownloadFileWriter::busy() {
+	if (!_worker || _finishing) {
+		return true;
+	}
+	prunePending();
+	const auto result = (_pendingBytes > kMaxPendingBytes);
+	_worker->waiting = result;
+	return result;
+}
+
+void DownloadFileWriter::written() {
+	if (_worker && _worker->waiting && !busy()) {
+		_ready();
+	}
+}
+
+QByteArray DownloadFileWriter::read(int64 offset, int size) {
+	Expects(_worker != nullptr);
+
+	if (failed() || offset + size > _size) {
+		return QByteArray();
+	}
+
+	// Everything that is not pending any more is already in the file,
+	// so read the file first and put the pending bytes over it. Until
+	// the first write is done the file may not be opened by the queue.
+	prunePending();
+	auto result = QByteArray(size, char(0));
+	if (_reader.isOpen()
+		|| (_worker->written > 0 && _reader.open(QIODevice::ReadOnly))) {
+		if (_reader.seek(offset)) {
+			_reader.read(result.data(), size);
+		}
+	}
+	const auto copy = [&](int64 from, const QByteArray &bytes) {
+		const auto start = std::max(from, offset);
+		const auto till = std::min(from + bytes.size(), offset + size);
+		if (start < till) {
+			memcpy(
+				result.data() + (start - offset),
+				bytes.constData() + (start - from),
+				till - start);
+		}
+	};
+	for (const auto &pending : _pending) {
+		copy(pending.offset, pending.bytes);
+	}
+	copy(_bufferOffset, _buffer);
+	return result;
+}
+
+void DownloadFileWriter::finish(Fn<void(bool)> done) {
+	Expects(_worker != nullptr);
+	Expects(!_finishing);
+
+	flush();
+	_finishing = true;
+	WritersQueue().async([
+		=,
+		worker = _worker,
+		size = _size,
+		weak = base::make_weak(this)
+	] {
+		worker->finish(size);
+		crl::on_main(weak, [=] {
+			_reader.close();
+			_pending.clear();
+			_pendingBytes = 0;
+			done(!failed());
+		});
+	});
+}
+
+void DownloadFileWriter::remove() {
+	if (!_worker) {
+		return;
+	}
+	_buffer = QByteArray();
+	_pending.clear();
+	_pendingBytes = 0;
+	_reader.close();
+	WritersQueue().async([worker = base::take(_worker)] {
+		worker->remove();
+	});
+}
+
+int64 DownloadFileWriter::size() const {
+	return _size;
+}
+
+bool DownloadFileWriter::failed() const {
+	return _worker && _worker->failed;
+}
+
+} // namespace Storage
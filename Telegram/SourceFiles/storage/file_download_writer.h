@@ -0,0 +1,74 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+
+namespace Storage {
+
+// Writes a file being downloaded in background.
+// Sequential parts are coalesced into larger writes, so the main
+// thread only copies bytes and never waits for the disk. Parts read
+// back are taken from the bytes not written yet and from the file.
+//
+// All the writers share one queue, so a file removed by a cancelled
+// writer can't be removed after a new writer for the same path opened it.
+class DownloadFileWriter final : public base::has_weak_ptr {
+public:
+	// ready() is called when the writer stops being busy().
+	DownloadFileWriter(const QString &path, Fn<void()> ready);
+	~DownloadFileWriter();
+
+	// Creates (truncates) the file.
+	[[nodiscard]] bool open();
+
+	void write(int64 offset, bytes::const_span buffer);
+	[[nodiscard]] QByteArray read(int64 offset, int size);
+
+	// Too much is waiting for the disk or the file is being finished,
+	// the loader shouldn't request more parts until ready() is called.
+	[[nodiscard]] bool busy();
+
+	// Calls done() on main when all the writes are done and the file
+	// is closed, with false if any of them failed.
+	void finish(Fn<void(bool)> done);
+	// Closes and removes the file in background.
+	void remove();
+
+	// Size of the written data, including not yet flushed parts.
+	[[nodiscard]] int64 size() const;
+	[[nodiscard]] bool failed() const;
+
+private:
+	struct Worker;
+
+	struct Pending {
+		int64 offset = 0;
+		QByteArray bytes;
+	};
+
+	void flush();
+	void prunePending();
+	void written();
+
+	const QString _path;
+	const Fn<void()> _ready;
+	std::shared_ptr<Worker> _worker;
+	QFile _reader;
+
+	std::deque<Pending> _pending;
+	int64 _pendingBytes = 0;
+	int _flushed = 0;
+	QByteArray _buffer;
+	int64 _bufferOffset = 0;
+	int64 _size = 0;
+	bool _finishing = false;
+
+};
+
+} // namespace Storage
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_domain.h"
 
 #include "storage/details/storage_file_utilities.h"
+#include "storage/storage_encryption.h"
 #include "storage/serialize_common.h"
 #include "mtproto/mtproto_config.h"
 #include "main/main_domain.h"
@@ -272,6 +273,18 @@ QString Domain::webviewDataPath() const {
 	return BaseGlobalPath() + "webview";
 }
 
+QString Domain::sharedCacheBigFilePath() const {
+	return BaseGlobalPath() + "user_" + _dataName + "_shared/media_cache";
+}
+
+EncryptionKey Domain::sharedCacheBigFileKey() const {
+	Expects(_localKey != nullptr);
+
+	// All accounts are started with the same local key,
+	// so the shared cache is encrypted the same way as theirs.
+	return EncryptionKey(bytes::make_vector(_localKey->data()));
+}
+
 rpl::producer<> Domain::localPasscodeChanged() const {
 	return _passcodeKeyChanged.events();
 }
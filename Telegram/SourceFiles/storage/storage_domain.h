@@ -20,6 +20,8 @@ class Domain;
 
 namespace Storage {
 
+class EncryptionKey;
+
 enum class StartResult : uchar {
 	Success,
 	IncorrectPasscode,
@@ -46,6 +48,10 @@ public:
 
 	[[nodiscard]] QString webviewDataPath() const;
 
+	// Media cache shared by all accounts of this domain.
+	[[nodiscard]] QString sharedCacheBigFilePath() const;
+	[[nodiscard]] EncryptionKey sharedCacheBigFileKey() const;
+
 	[[nodiscard]] rpl::producer<> localPasscodeChanged() const;
 	[[nodiscard]] bool hasLocalPasscode() const;
 
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/ui_utility.h"
 #include "ui/chat/message_bubble.h"
 #include "ui/chat/chat_style.h"
+#include "ui/chat/chat_theme_kernels.h"
 #include "ui/style/style_core_palette.h"
 #include "ui/style/style_palette_colorizer.h"
 
@@ -770,23 +771,13 @@ QColor CountAverageColor(const QImage &image) {
 	Expects(image.format() == QImage::Format_ARGB32_Premultiplied
 		|| image.format() == QImage::Format_RGB32);
 
-	uint64 components[3] = { 0 };
-	const auto w = image.width();
-	const auto h = image.height();
-	const auto size = w * h;
-	if (const auto pix = image.constBits()) {
-		for (auto i = 0, l = size * 4; i != l; i += 4) {
-			components[2] += pix[i + 0];
-			components[1] += pix[i + 1];
-			components[0] += pix[i + 2];
-		}
-	}
-	if (size) {
-		for (auto &component : components) {
-			component /= size;
-		}
+	const auto size = int64(image.width()) * image.height();
+	const auto pixels = reinterpret_cast<const uint32*>(image.constBits());
+	if (!pixels || !size) {
+		return QColor(0, 0, 0);
 	}
-	return QColor(components[0], components[1], components[2]);
+	const auto sums = Kernels::SumChannels(pixels, size);
+	return QColor(sums.r / size, sums.g / size, sums.b / size);
 }
 
 QColor CountAverageColor(const std::vector<QColor> &colors) {
@@ -860,11 +851,9 @@ std::optional<QColor> CalculateImageMonoColor(const QImage &image) {
 		return std::nullopt;
 	}
 	const auto bits = reinterpret_cast<const uint32*>(image.constBits());
-	const auto first = bits[0];
-	for (auto i = 0; i < image.width() * image.height(); i++) {
-		if (first != bits[i]) {
-			return std::nullopt;
-		}
+	const auto size = int64(image.width()) * image.height();
+	if (!Kernels::AllEqual(bits, size)) {
+		return std::nullopt;
 	}
 	return image.pixelColor(QPoint());
 }
@@ -969,15 +958,8 @@ QImage InvertPatternImage(QImage pattern) {
 	pattern = std::move(pattern).convertToFormat(
 		QImage::Format_ARGB32_Premultiplied);
 	const auto w = pattern.bytesPerLine() / 4;
-	auto ints = reinterpret_cast<uint32*>(pattern.bits());
-	for (auto y = 0, h = pattern.height(); y != h; ++y) {
-		for (auto x = 0; x != w; ++x) {
-			const auto value = (*ints >> 24);
-			*ints++ = (value << 24)
-				| (value << 16)
-				| (value << 8)
-				| value;
-		}
+	if (const auto ints = reinterpret_cast<uint32*>(pattern.bits())) {
+		Kernels::SpreadAlpha(ints, int64(w) * pattern.height());
 	}
 	return pattern;
 }
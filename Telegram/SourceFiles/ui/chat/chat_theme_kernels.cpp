@@ -0,0 +1,356 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "ui/chat/chat_theme_kernels.h"
+
+#if defined Q_PROCESSOR_X86_64 \
+	|| (defined Q_CC_MSVC && defined Q_PROCESSOR_X86_32)
+#define TDESKTOP_KERNELS_X86
+#include <immintrin.h>
+#ifdef Q_CC_MSVC
+#include <intrin.h>
+#endif // Q_CC_MSVC
+#elif defined __ARM_NEON || defined _M_ARM64 // Q_PROCESSOR_X86_64 || ..
+#define TDESKTOP_KERNELS_NEON
+#include <arm_neon.h>
+#endif // Q_PROCESSOR_X86_64 || .. || __ARM_NEON
+
+#if defined TDESKTOP_KERNELS_X86 && !defined Q_CC_MSVC
+#define TDESKTOP_KERNELS_AVX2_TARGET __attribute__((target("avx2")))
+#else // TDESKTOP_KERNELS_X86 && !Q_CC_MSVC
+#define TDESKTOP_KERNELS_AVX2_TARGET
+#endif // TDESKTOP_KERNELS_X86 && !Q_CC_MSVC
+
+namespace Ui::Kernels {
+namespace {
+
+enum class Implementation {
+	Scalar,
+	SSE2,
+	AVX2,
+	NEON,
+};
+
+[[nodiscard]] ChannelSums SumChannelsScalar(
+		const uint32 *pixels,
+		int64 count) {
+	auto result = ChannelSums();
+	for (const auto till = pixels + count; pixels != till; ++pixels) {
+		const auto value = *pixels;
+		result.b += (value & 0xFFU);
+		result.g += ((value >> 8) & 0xFFU);
+		result.r += ((value >> 16) & 0xFFU);
+	}
+	return result;
+}
+
+void SpreadAlphaScalar(uint32 *pixels, int64 count) {
+	for (const auto till = pixels + count; pixels != till; ++pixels) {
+		const auto value = (*pixels >> 24);
+		*pixels = (value << 24) | (value << 16) | (value << 8) | value;
+	}
+}
+
+[[nodiscard]] bool AllEqualScalar(const uint32 *pixels, int64 count) {
+	const auto first = pixels[0];
+	for (const auto till = pixels + count; pixels != till; ++pixels) {
+		if (*pixels != first) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#ifdef TDESKTOP_KERNELS_X86
+
+[[nodiscard]] bool HasAVX2() {
+#ifdef Q_CC_MSVC
+	int info[4] = { 0 };
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	const auto osxsave = (info[2] & (1 << 27)) != 0;
+	const auto avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || ((_xgetbv(0) & 0x06) != 0x06)) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else // Q_CC_MSVC
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif // Q_CC_MSVC
+}
+
+[[nodiscard]] ChannelSums SumChannelsSSE2(
+		const uint32 *pixels,
+		int64 count) {
+	const auto mask = _mm_set1_epi32(0xFF);
+	const auto zero = _mm_setzero_si128();
+	auto b = _mm_setzero_si128();
+	auto g = _mm_setzero_si128();
+	auto r = _mm_setzero_si128();
+	const auto full = count & ~int64(3);
+	for (auto i = int64(0); i != full; i += 4) {
+		const auto value = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(pixels + i));
+		b = _mm_add_epi64(
+			b,
+			_mm_sad_epu8(_mm_and_si128(value, mask), zero));
+		g = _mm_add_epi64(
+			g,
+			_mm_sad_epu8(
+				_mm_and_si128(_mm_srli_epi32(value, 8), mask),
+				zero));
+		r = _mm_add_epi64(
+			r,
+			_mm_sad_epu8(
+				_mm_and_si128(_mm_srli_epi32(value, 16), mask),
+				zero));
+	}
+	alignas(16) uint64 lanes[2];
+	auto result = SumChannelsScalar(pixels + full, count - full);
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), b);
+	result.b += lanes[0] + lanes[1];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), g);
+	result.g += lanes[0] + lanes[1];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), r);
+	result.r += lanes[0] + lanes[1];
+	return result;
+}
+
+TDESKTOP_KERNELS_AVX2_TARGET ChannelSums SumChannelsAVX2(
+		const uint32 *pixels,
+		int64 count) {
+	const auto mask = _mm256_set1_epi32(0xFF);
+	const auto zero = _mm256_setzero_si256();
+	auto b = _mm256_setzero_si256();
+	auto g = _mm256_setzero_si256();
+	auto r = _mm256_setzero_si256();
+	const auto full = count & ~int64(7);
+	for (auto i = int64(0); i != full; i += 8) {
+		const auto value = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(pixels + i));
+		b = _mm256_add_epi64(
+			b,
+			_mm256_sad_epu8(_mm256_and_si256(value, mask), zero));
+		g = _mm256_add_epi64(
+			g,
+			_mm256_sad_epu8(
+				_mm256_and_si256(_mm256_srli_epi32(value, 8), mask),
+				zero));
+		r = _mm256_add_epi64(
+			r,
+			_mm256_sad_epu8(
+				_mm256_and_si256(_mm256_srli_epi32(value, 16), mask),
+				zero));
+	}
+	alignas(32) uint64 lanes[4];
+	auto result = SumChannelsSSE2(pixels + full, count - full);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), b);
+	result.b += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), g);
+	result.g += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), r);
+	result.r += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	return result;
+}
+
+void SpreadAlphaSSE2(uint32 *pixels, int64 count) {
+	const auto full = count & ~int64(3);
+	for (auto i = int64(0); i != full; i += 4) {
+		const auto address = reinterpret_cast<__m128i*>(pixels + i);
+		auto value = _mm_srli_epi32(_mm_loadu_si128(address), 24);
+		value = _mm_or_si128(value, _mm_slli_epi32(value, 8));
+		value = _mm_or_si128(value, _mm_slli_epi32(value, 16));
+		_mm_storeu_si128(address, value);
+	}
+	SpreadAlphaScalar(pixels + full, count - full);
+}
+
+TDESKTOP_KERNELS_AVX2_TARGET void SpreadAlphaAVX2(
+		uint32 *pixels,
+		int64 count) {
+	const auto full = count & ~int64(7);
+	for (auto i = int64(0); i != full; i += 8) {
+		const auto address = reinterpret_cast<__m256i*>(pixels + i);
+		auto value = _mm256_srli_epi32(_mm256_loadu_si256(address), 24);
+		value = _mm256_or_si256(value, _mm256_slli_epi32(value, 8));
+		value = _mm256_or_si256(value, _mm256_slli_epi32(value, 16));
+		_mm256_storeu_si256(address, value);
+	}
+	SpreadAlphaSSE2(pixels + full, count - full);
+}
+
+[[nodiscard]] bool AllEqualSSE2(const uint32 *pixels, int64 count) {
+	const auto first = _mm_set1_epi32(int(pixels[0]));
+	const auto full = count & ~int64(3);
+	for (auto i = int64(0); i != full; i += 4) {
+		const auto value = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(pixels + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(value, first)) != 0xFFFF) {
+			return false;
+		}
+	}
+	return (full == count)
+		|| (pixels[full] == pixels[0]
+			&& AllEqualScalar(pixels + full, count - full));
+}
+
+TDESKTOP_KERNELS_AVX2_TARGET bool AllEqualAVX2(
+		const uint32 *pixels,
+		int64 count) {
+	const auto first = _mm256_set1_epi32(int(pixels[0]));
+	const auto full = count & ~int64(7);
+	for (auto i = int64(0); i != full; i += 8) {
+		const auto value = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(pixels + i));
+		const auto equal = _mm256_cmpeq_epi32(value, first);
+		if (uint32(_mm256_movemask_epi8(equal)) != 0xFFFFFFFFU) {
+			return false;
+		}
+	}
+	return (full == count)
+		|| (pixels[full] == pixels[0]
+			&& AllEqualSSE2(pixels + full, count - full));
+}
+
+#elif defined TDESKTOP_KERNELS_NEON // TDESKTOP_KERNELS_X86
+
+[[nodiscard]] ChannelSums SumChannelsNEON(
+		const uint32 *pixels,
+		int64 count) {
+	auto b = vdupq_n_u64(0);
+	auto g = vdupq_n_u64(0);
+	auto r = vdupq_n_u64(0);
+	const auto full = count & ~int64(15);
+	const auto bytes = reinterpret_cast<const uint8*>(pixels);
+	for (auto i = int64(0); i != full; i += 16) {
+		const auto value = vld4q_u8(bytes + i * 4);
+		b = vpadalq_u32(b, vpaddlq_u16(vpaddlq_u8(value.val[0])));
+		g = vpadalq_u32(g, vpaddlq_u16(vpaddlq_u8(value.val[1])));
+		r = vpadalq_u32(r, vpaddlq_u16(vpaddlq_u8(value.val[2])));
+	}
+	auto result = SumChannelsScalar(pixels + full, count - full);
+	result.b += vgetq_lane_u64(b, 0) + vgetq_lane_u64(b, 1);
+	result.g += vgetq_lane_u64(g, 0) + vgetq_lane_u64(g, 1);
+	result.r += vgetq_lane_u64(r, 0) + vgetq_lane_u64(r, 1);
+	return result;
+}
+
+void SpreadAlphaNEON(uint32 *pixels, int64 count) {
+	const auto full = count & ~int64(3);
+	for (auto i = int64(0); i != full; i += 4) {
+		auto value = vshrq_n_u32(vld1q_u32(pixels + i), 24);
+		value = vorrq_u32(value, vshlq_n_u32(value, 8));
+		value = vorrq_u32(value, vshlq_n_u32(value, 16));
+		vst1q_u32(pixels + i, value);
+	}
+	SpreadAlphaScalar(pixels + full, count - full);
+}
+
+[[nodiscard]] bool AllEqualNEON(const uint32 *pixels, int64 count) {
+	const auto first = vdupq_n_u32(pixels[0]);
+	const auto full = count & ~int64(3);
+	for (auto i = int64(0); i != full; i += 4) {
+		const auto equal = vceqq_u32(vld1q_u32(pixels + i), first);
+
+		// Pairwise min instead of vminvq_u32, that is AArch64 only.
+		const auto half = vpmin_u32(
+			vget_low_u32(equal),
+			vget_high_u32(equal));
+		if (vget_lane_u32(vpmin_u32(half, half), 0) != 0xFFFFFFFFU) {
+			return false;
+		}
+	}
+	return (full == count)
+		|| (pixels[full] == pixels[0]
+			&& AllEqualScalar(pixels + full, count - full));
+}
+
+#endif // TDESKTOP_KERNELS_X86 || TDESKTOP_KERNELS_NEON
+
+[[nodiscard]] Implementation Choose() {
+#ifdef TDESKTOP_KERNELS_X86
+	return HasAVX2() ? Implementation::AVX2 : Implementation::SSE2;
+#elif defined TDESKTOP_KERNELS_NEON // TDESKTOP_KERNELS_X86
+	return Implementation::NEON;
+#else // TDESKTOP_KERNELS_X86 || TDESKTOP_KERNELS_NEON
+	return Implementation::Scalar;
+#endif // TDESKTOP_KERNELS_X86 || TDESKTOP_KERNELS_NEON
+}
+
+[[nodiscard]] const char *ImplementationName(Implementation value) {
+	switch (value) {
+	case Implementation::Scalar: return "scalar";
+	case Implementation::SSE2: return "SSE2";
+	case Implementation::AVX2: return "AVX2";
+	case Implementation::NEON: return "NEON";
+	}
+	Unexpected("Value in Ui::Kernels::ImplementationName.");
+}
+
+[[nodiscard]] Implementation Chosen() {
+	static const auto result = [] {
+		const auto result = Choose();
+		LOG(("Background Info: Using %1 pixel kernels."
+			).arg(ImplementationName(result)));
+		return result;
+	}();
+	return result;
+}
+
+} // namespace
+
+ChannelSums SumChannels(const uint32 *pixels, int64 count) {
+	if (count <= 0) {
+		return {};
+	}
+	switch (Chosen()) {
+#ifdef TDESKTOP_KERNELS_X86
+	case Implementation::AVX2: return SumChannelsAVX2(pixels, count);
+	case Implementation::SSE2: return SumChannelsSSE2(pixels, count);
+#elif defined TDESKTOP_KERNELS_NEON // TDESKTOP_KERNELS_X86
+	case Implementation::NEON: return SumChannelsNEON(pixels, count);
+#endif // TDESKTOP_KERNELS_X86 || TDESKTOP_KERNELS_NEON
+	default: return SumChannelsScalar(pixels, count);
+	}
+}
+
+void SpreadAlpha(uint32 *pixels, int64 count) {
+	if (count <= 0) {
+		return;
+	}
+	switch (Chosen()) {
+#ifdef TDESKTOP_KERNELS_X86
+	case Implementation::AVX2: SpreadAlphaAVX2(pixels, count); return;
+	case Implementation::SSE2: SpreadAlphaSSE2(pixels, count); return;
+#elif defined TDESKTOP_KERNELS_NEON // TDESKTOP_KERNELS_X86
+	case Implementation::NEON: SpreadAlphaNEON(pixels, count); return;
+#endif // TDESKTOP_KERNELS_X86 || TDESKTOP_KERNELS_NEON
+	default: SpreadAlphaScalar(pixels, count); return;
+	}
+}
+
+bool AllEqual(const uint32 *pixels, int64 count) {
+	if (count <= 1) {
+		return true;
+	}
+	switch (Chosen()) {
+#ifdef TDESKTOP_KERNELS_X86
+	case Implementation::AVX2: return AllEqualAVX2(pixels, count);
+	case Implementation::SSE2: return AllEqualSSE2(pixels, count);
+#elif defined TDESKTOP_KERNELS_NEON // TDESKTOP_KERNELS_X86
+	case Implementation::NEON: return AllEqualNEON(pixels, count);
+#endif // TDESKTOP_KERNELS_X86 || TDESKTOP_KERNELS_NEON
+	default: return AllEqualScalar(pixels, count);
+	}
+}
+
+} // namespace Ui::Kernels
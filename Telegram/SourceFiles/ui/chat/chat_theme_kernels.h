@@ -0,0 +1,31 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Ui::Kernels {
+
+// Per-pixel loops used while preparing chat backgrounds.
+// All of them work on tightly packed 32 bit pixels (ARGB32 / RGB32).
+//
+// The implementation is picked once at runtime: AVX2 if the CPU
+// supports it, SSE2 on the rest of x86, NEON on ARM64, scalar otherwise.
+
+struct ChannelSums {
+	uint64 b = 0;
+	uint64 g = 0;
+	uint64 r = 0;
+};
+
+[[nodiscard]] ChannelSums SumChannels(const uint32 *pixels, int64 count);
+
+// Replaces each pixel with its alpha repeated in all four channels.
+void SpreadAlpha(uint32 *pixels, int64 count);
+
+[[nodiscard]] bool AllEqual(const uint32 *pixels, int64 count);
+
+} // namespace Ui::Kernels
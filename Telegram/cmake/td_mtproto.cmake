@@ -25,6 +25,7 @@ PRIVATE
     mtproto/details/mtproto_domain_resolver.h
     mtproto/details/mtproto_dump_to_text.cpp
     mtproto/details/mtproto_dump_to_text.h
+    mtproto/details/mtproto_hand_off_queue.h
     mtproto/details/mtproto_received_ids_manager.cpp
     mtproto/details/mtproto_received_ids_manager.h
     mtproto/details/mtproto_rsa_public_key.cpp
@@ -148,6 +148,8 @@ PRIVATE
     ui/chat/chat_style.h
     ui/chat/chat_theme.cpp
     ui/chat/chat_theme.h
+    ui/chat/chat_theme_kernels.cpp
+    ui/chat/chat_theme_kernels.h
     ui/chat/continuous_scroll.cpp
     ui/chat/continuous_scroll.h
     ui/chat/forward_options_box.cpp